@@ -47,3 +47,52 @@ struct scnhdr {
         long            s_flags;        /* flags */
       };
  
+
+/* The symbolic header, found at f_symptr.  MIPS COFF ("ECOFF") files
+ * keep their symbol table in several sub-tables described here; we
+ * only use the external symbols and their string table.
+ */
+
+typedef struct hdrr {
+        short   magic;          /* SYMMAGIC */
+        short   vstamp;         /* version stamp */
+        long    ilineMax;       /* number of line number entries */
+        long    cbLine;         /* bytes of packed line numbers */
+        long    cbLineOffset;   /* offset of the line numbers */
+        long    idnMax;         /* max index into dense numbers */
+        long    cbDnOffset;     /* offset of the dense numbers */
+        long    ipdMax;         /* number of procedure descriptors */
+        long    cbPdOffset;     /* offset of the procedure descriptors */
+        long    isymMax;        /* number of local symbols */
+        long    cbSymOffset;    /* offset of the local symbols */
+        long    ioptMax;        /* max index into optimization entries */
+        long    cbOptOffset;    /* offset of the optimization entries */
+        long    iauxMax;        /* number of auxiliary symbols */
+        long    cbAuxOffset;    /* offset of the auxiliary symbols */
+        long    issMax;         /* size of the local string table */
+        long    cbSsOffset;     /* offset of the local string table */
+        long    issExtMax;      /* size of the external string table */
+        long    cbSsExtOffset;  /* offset of the external string table */
+        long    ifdMax;         /* number of file descriptors */
+        long    cbFdOffset;     /* offset of the file descriptors */
+        long    crfd;           /* number of relative file descriptors */
+        long    cbRfdOffset;    /* offset of the relative file descriptors */
+        long    iextMax;        /* number of external symbols */
+        long    cbExtOffset;    /* offset of the external symbols */
+      } HDRR;
+
+#define SYMMAGIC        0x7009
+
+/* An external symbol. */
+
+typedef struct extr {
+        unsigned short  flags;  /* jump table, weak, ... */
+        short   ifd;            /* file this symbol comes from */
+        long    iss;            /* name, in the external string table */
+        long    value;          /* address, for procedures */
+        unsigned long   bits;   /* st:6, sc:5, reserved:1, index:20 */
+      } EXTR;
+
+#define SymType(bits)   ((bits) & 0x3f)
+#define stProc          6       /* global procedure */
+#define stStaticProc    14      /* static procedure */
@@ -15,6 +15,10 @@
  *	.data	-- initialized data
  *	.bss/.sbss -- uninitialized data (should be zero'd on program startup)
  *
+ * If the COFF file has a symbol table, the address and name of every
+ * global procedure is also written, one per line, to <noffFileName>.sym,
+ * for the Nachos profiler ("nachos -prof").
+ *
  * Copyright (c) 1992-1993 The Regents of the University of California.
  * All rights reserved.  See copyright.h for copyright notice and limitation 
  * of liability and disclaimer of warranty provisions.
@@ -91,13 +95,60 @@ void Write(int fd, char *buf, int nBytes)
     }
 }
 
+/* Write the procedures found in the external symbols of the COFF
+ * file to symFileName.  Files without a symbol table (stripped) are
+ * silently skipped.
+ */
+void WriteSymbols(int fdIn, struct filehdr *fileh, char *symFileName)
+{
+    HDRR symh;
+    EXTR ext;
+    char *strings;
+    FILE *symFile;
+    int i;
+
+    if (WordToHost(fileh->f_symptr) == 0)
+	return;
+    lseek(fdIn, WordToHost(fileh->f_symptr), 0);
+    ReadStruct(fdIn, symh);
+    if (ShortToHost(symh.magic) != SYMMAGIC) {
+	fprintf(stderr, "Unknown symbol table format, no symbols written\n");
+	return;
+    }
+    strings = malloc(WordToHost(symh.issExtMax) + 1);
+    lseek(fdIn, WordToHost(symh.cbSsExtOffset), 0);
+    Read(fdIn, strings, WordToHost(symh.issExtMax));
+    strings[WordToHost(symh.issExtMax)] = '\0';
+
+    symFile = fopen(symFileName, "w");
+    if (symFile == NULL) {
+	perror(symFileName);
+	free(strings);
+	return;
+    }
+    lseek(fdIn, WordToHost(symh.cbExtOffset), 0);
+    for (i = 0; i < WordToHost(symh.iextMax); i++) {
+	ReadStruct(fdIn, ext);
+	switch (SymType(WordToHost(ext.bits))) {
+	  case stProc:
+	  case stStaticProc:
+	    if (WordToHost(ext.iss) < WordToHost(symh.issExtMax))
+		fprintf(symFile, "%08x %s\n", WordToHost(ext.value),
+			strings + WordToHost(ext.iss));
+	    break;
+	}
+    }
+    fclose(symFile);
+    free(strings);
+}
+
 int main (int argc, char **argv)
 {
     int fdIn, fdOut, numsections, i, inNoffFile;
     struct filehdr fileh;
     struct aouthdr systemh;
     struct scnhdr *sections;
-    char *buffer;
+    char *buffer, *symFileName;
     NoffHeader noffH;
 
     if (argc < 2) {
@@ -249,6 +300,13 @@ int main (int argc, char **argv)
     }
     lseek(fdOut, 0, 0);
     Write(fdOut, (char *)&noffH, sizeof(NoffHeader));
+
+/* Write the symbols for the profiler */
+    symFileName = malloc(strlen(argv[2]) + 5);
+    sprintf(symFileName, "%s.sym", argv[2]);
+    WriteSymbols(fdIn, &fileh, symFileName);
+    free(symFileName);
+
     close(fdIn);
     close(fdOut);
     exit(0);
@@ -31,6 +31,7 @@ OpenFile::OpenFile(int sector)
 { 
     hdr = new FileHeader;
     hdr->FetchFrom(sector);
+    headerSector = sector;
     seekPosition = 0;
 
     if(sector != 0 && sector != 1) //map and directory
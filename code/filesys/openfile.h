@@ -52,6 +52,7 @@ class OpenFile {
 		}
 
     int Length() { Lseek(file, 0, 2); return Tell(file); }
+    int Identity() { return FileNumber(file); }
     
   private:
     int file;
@@ -87,9 +88,12 @@ class OpenFile {
 					// end of file, tell, lseek back
                      
     FileHeader* getFileHeader();
+    int Identity() { return headerSector; }	// The same for all the
+					// OpenFiles of a file
     
   private:
     FileHeader *hdr;			// Header for this file 
+    int headerSector;			// Where it is on disk
     int seekPosition;			// Current position within the file
 };
 
@@ -16,6 +16,7 @@
 
 #include "copyright.h"
 #include "synchdisk.h"
+#include "system.h"
 
 //----------------------------------------------------------------------
 // DiskRequestDone
@@ -74,6 +75,7 @@ SynchDisk::ReadSector(int sectorNumber, char* data)
 {
     lock->Acquire();			// only one disk I/O at a time
     disk->ReadRequest(sectorNumber, data);
+    scheduler->IoWait(currentThread);	// let the scheduler favor us
     semaphore->P();			// wait for interrupt
     lock->Release();
 }
@@ -92,6 +94,7 @@ SynchDisk::WriteSector(int sectorNumber, char* data)
 {
     lock->Acquire();			// only one disk I/O at a time
     disk->WriteRequest(sectorNumber, data);
+    scheduler->IoWait(currentThread);	// let the scheduler favor us
     semaphore->P();			// wait for interrupt
     lock->Release();
 }
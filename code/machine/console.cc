@@ -57,6 +57,7 @@ Console::Console(char *readFile, char *writeFile, VoidFunctionPtr readAvail,
 
     // start polling for incoming packets
     interrupt->Schedule(ConsoleReadPoll, (int)this, ConsoleTime, ConsoleReadInt);
+    interrupt->WatchInput(readFileNo);
 }
 
 //----------------------------------------------------------------------
@@ -66,6 +67,7 @@ Console::Console(char *readFile, char *writeFile, VoidFunctionPtr readAvail,
 
 Console::~Console()
 {
+    interrupt->UnwatchInput(readFileNo);
     if (readFileNo != 0)
 	Close(readFileNo);
     if (writeFileNo != 1)
@@ -100,6 +102,8 @@ Console::CheckCharAvail()
     // otherwise, read character and tell user about it
     n = ReadPartial(readFileNo, &c, sizeof(char));
     incoming = (n == 1 ? c : EOF);
+    if (incoming != EOF)		// no room for more until it is read
+	interrupt->UnwatchInput(readFileNo);
     stats->numConsoleCharsRead++;
     (*readHandler)(handlerArg);	
 }
@@ -131,6 +135,7 @@ Console::GetChar()
    char ch = incoming;
 
    incoming = EOF;
+   interrupt->WatchInput(readFileNo);	// room for the next character
    return ch;
 }
 
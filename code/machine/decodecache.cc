@@ -0,0 +1,206 @@
+// decodecache.cc
+//	Routines to manage the cache of predecoded user instructions.
+//
+//	A frame is decoded all at once, the first time the simulator
+//	fetches an instruction from it.  Decoding a whole page is cheap
+//	(PageSize / 4 instructions), and the code around the first
+//	instruction fetched is very likely to be executed soon anyway.
+//
+//	Any write to a decoded frame, whether by the user program itself
+//	or by the kernel through Machine::WriteMem, and any release of
+//	the frame to the frame provider, throws the decoded copy away.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "decodecache.h"
+#include "mipssim.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// EndsBlock
+// 	Return the number of instructions, counting "instr" itself,
+//	that must still be executed before control may leave the
+//	straight-line path: 2 for a branch or jump (because of the
+//	delay slot), 1 for an instruction that always traps, 0 otherwise.
+//----------------------------------------------------------------------
+
+static int
+EndsBlock(Instruction *instr)
+{
+    switch (instr->opCode) {
+      case OP_BEQ:
+      case OP_BGEZ:
+      case OP_BGEZAL:
+      case OP_BGTZ:
+      case OP_BLEZ:
+      case OP_BLTZ:
+      case OP_BLTZAL:
+      case OP_BNE:
+      case OP_J:
+      case OP_JAL:
+      case OP_JALR:
+      case OP_JR:
+	return 2;
+
+      case OP_SYSCALL:
+      case OP_RES:
+      case OP_UNIMP:
+	return 1;
+
+      default:
+	return 0;
+    }
+}
+
+//----------------------------------------------------------------------
+// DecodeCache::DecodeCache
+// 	Initialize an empty cache covering "numFrames" physical frames.
+//----------------------------------------------------------------------
+
+DecodeCache::DecodeCache(int nFrames)
+{
+    numFrames = nFrames;
+    decoded = new bool[numFrames];
+    instrs = new Instruction[numFrames * InstrsPerPage];
+    blockLen = new unsigned char[numFrames * InstrsPerPage];
+    heat = new unsigned short[numFrames * InstrsPerPage];
+    ops = new MicroOp[numFrames * InstrsPerPage];
+    InvalidateAll();
+}
+
+//----------------------------------------------------------------------
+// DecodeCache::~DecodeCache
+// 	De-allocate the cache.
+//----------------------------------------------------------------------
+
+DecodeCache::~DecodeCache()
+{
+    delete [] decoded;
+    delete [] instrs;
+    delete [] blockLen;
+    delete [] heat;
+    delete [] ops;
+}
+
+//----------------------------------------------------------------------
+// DecodeCache::Lookup
+// 	Return the decoded form of the instruction at word "slot" of
+//	physical frame "frame", decoding the frame if it is not cached.
+//
+//	"blockLen" -- set to the number of instructions, starting at
+//	the returned one, that can be executed in sequence before the
+//	simulator has to look at the PC again.
+//----------------------------------------------------------------------
+
+Instruction *
+DecodeCache::Lookup(int frame, int slot, int *len)
+{
+    ASSERT((frame >= 0) && (frame < numFrames));
+    ASSERT((slot >= 0) && (slot < InstrsPerPage));
+
+    if (!decoded[frame])
+	DecodeFrame(frame);
+    *len = blockLen[frame * InstrsPerPage + slot];
+    return &instrs[frame * InstrsPerPage + slot];
+}
+
+//----------------------------------------------------------------------
+// DecodeCache::IsHot
+// 	Count one more execution of the block starting at "head" (a
+//	decoded instruction returned by Lookup), and tell whether it has
+//	run often enough to be worth compiling into micro-ops.
+//----------------------------------------------------------------------
+
+bool
+DecodeCache::IsHot(Instruction *head)
+{
+    unsigned short *h = &heat[head - instrs];
+
+    if (*h >= HotThreshold)
+	return TRUE;
+    (*h)++;
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// DecodeCache::MicroOps
+// 	Return the array of micro-ops parallel to the "len" decoded
+//	instructions starting at "head", selecting the missing ones.
+//	The micro-ops are dropped with the decoded frame, when the frame
+//	is written to or released.
+//----------------------------------------------------------------------
+
+MicroOp *
+DecodeCache::MicroOps(Instruction *head, int len)
+{
+    MicroOp *first = &ops[head - instrs];
+
+    for (int i = 0; i < len; i++)
+	if (first[i] == NULL)
+	    first[i] = SelectMicroOp(&head[i]);
+    return first;
+}
+
+//----------------------------------------------------------------------
+// DecodeCache::Invalidate
+// 	Throw away the decoded copy of "frame", because its contents
+//	are about to change.
+//----------------------------------------------------------------------
+
+void
+DecodeCache::Invalidate(int frame)
+{
+    ASSERT((frame >= 0) && (frame < numFrames));
+    if (decoded[frame])
+	DEBUG('m', "Invalidating decoded frame %d\n", frame);
+    decoded[frame] = FALSE;
+}
+
+//----------------------------------------------------------------------
+// DecodeCache::InvalidateAll
+// 	Throw away every decoded frame.
+//----------------------------------------------------------------------
+
+void
+DecodeCache::InvalidateAll()
+{
+    for (int i = 0; i < numFrames; i++)
+	decoded[i] = FALSE;
+}
+
+//----------------------------------------------------------------------
+// DecodeCache::DecodeFrame
+// 	Decode every word of "frame", then compute the block lengths
+//	backwards from the end of the page: a block runs until the next
+//	instruction that ends one (see EndsBlock), or the end of the page,
+//	whichever comes first.
+//----------------------------------------------------------------------
+
+void
+DecodeCache::DecodeFrame(int frame)
+{
+    Instruction *page = &instrs[frame * InstrsPerPage];
+    unsigned char *len = &blockLen[frame * InstrsPerPage];
+    unsigned int *words =
+	(unsigned int *) &machine->mainMemory[frame * PageSize];
+    int i, end;
+
+    DEBUG('m', "Decoding frame %d\n", frame);
+    for (i = 0; i < InstrsPerPage; i++) {
+	page[i].Decode(WordToHost(words[i]));
+	heat[frame * InstrsPerPage + i] = 0;
+	ops[frame * InstrsPerPage + i] = NULL;
+    }
+
+    for (i = InstrsPerPage - 1; i >= 0; i--) {
+	end = EndsBlock(&page[i]);
+	if (end == 0)
+	    len[i] = (i + 1 < InstrsPerPage) ? len[i + 1] + 1 : 1;
+	else
+	    len[i] = (i + end <= InstrsPerPage) ? end : 1;
+    }
+    decoded[frame] = TRUE;
+}
@@ -0,0 +1,81 @@
+// decodecache.h
+//	Data structures for caching predecoded user instructions.
+//
+//	Fetching and decoding a MIPS instruction costs a full address
+//	translation plus a call to Instruction::Decode.  Since user code
+//	is almost never modified, we decode each physical page of code
+//	once, and keep the decoded instructions around until the page
+//	is written or given back to the frame provider.
+//
+//	Each decoded slot also records the length of the straight-line
+//	run ("basic block") that starts at that slot: the number of
+//	instructions up to and including the next branch (and its delay
+//	slot), system call or illegal instruction, or the end of the page.
+//	The simulator walks those runs without translating the PC again.
+//
+//	The cache is indexed by physical frame number, so one cache
+//	serves every address space: a frame belongs to a single address
+//	space at a time, and is invalidated when it is released.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef DECODECACHE_H
+#define DECODECACHE_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "machine.h"
+
+#define InstrsPerPage	(PageSize / 4)	// decoded slots in one frame
+#define HotThreshold	64		// executions before a block is
+					// compiled into micro-ops
+
+// A micro-op executes one decoded instruction, specialized for its
+// opcode (and sometimes operands), including the delayed load and the
+// update of the program counters.  It returns FALSE if the instruction
+// trapped, in which case the exception has already been handled.
+// Micro-ops are chosen by SelectMicroOp (tiered.cc).
+
+typedef bool (*MicroOp)(Machine *machine, Instruction *instr);
+
+extern MicroOp SelectMicroOp(Instruction *instr);
+
+class DecodeCache {
+  public:
+    DecodeCache(int numFrames);		// Initialize an empty cache
+    ~DecodeCache();
+
+    Instruction *Lookup(int frame, int slot, int *blockLen);
+					// Return the decoded instruction at
+					// "slot" in "frame", decoding the
+					// frame first if needed.  Also
+					// return the length of the block
+					// starting there.
+
+    bool IsDecoded(int frame) { return decoded[frame]; }
+
+    bool IsHot(Instruction *head);	// Count one more execution of the
+					// block starting at "head"; is it
+					// worth compiling?
+    MicroOp *MicroOps(Instruction *head, int len);
+					// Return the micro-ops for the "len"
+					// instructions starting at "head",
+					// selecting them if needed
+    void Invalidate(int frame);		// Forget the contents of "frame"
+    void InvalidateAll();		// Forget everything
+
+  private:
+    void DecodeFrame(int frame);	// Fill the slots of "frame"
+
+    int numFrames;			// Number of physical frames covered
+    bool *decoded;			// Is the frame currently decoded?
+    Instruction *instrs;		// numFrames * InstrsPerPage slots
+    unsigned char *blockLen;		// Block length from each slot
+    unsigned short *heat;		// Executions of the block starting
+					// at each slot, up to HotThreshold
+    MicroOp *ops;			// Micro-op for each slot, or NULL
+};
+
+#endif // DECODECACHE_H
@@ -0,0 +1,207 @@
+// eventqueue.cc
+//	Routines to manage the queue of pending interrupts, a binary
+//	heap sorted by the time at which the interrupts are due, then by
+//	the order in which they were scheduled.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "eventqueue.h"
+#include "interrupt.h"
+
+#define InitialHeapSize	16	// the heap doubles when full
+
+//----------------------------------------------------------------------
+// EventQueue::EventQueue
+// 	Initialize an empty queue of pending interrupts.
+//----------------------------------------------------------------------
+
+EventQueue::EventQueue()
+{
+    size = InitialHeapSize;
+    heap = new PendingInterrupt *[size];
+    numPending = 0;
+    nextSeq = 0;
+}
+
+//----------------------------------------------------------------------
+// EventQueue::~EventQueue
+// 	De-allocate the queue.  The interrupts still in it are not
+//	de-allocated: that is up to the owner of the queue.
+//----------------------------------------------------------------------
+
+EventQueue::~EventQueue()
+{
+    delete [] heap;
+}
+
+//----------------------------------------------------------------------
+// EventQueue::Before
+// 	Return TRUE if "a" must be taken out of the queue before "b":
+//	it is due earlier, or at the same time but was inserted first.
+//	Sequence numbers are compared modulo 2^32, so that they can
+//	wrap around.
+//----------------------------------------------------------------------
+
+bool
+EventQueue::Before(PendingInterrupt *a, PendingInterrupt *b)
+{
+    if (a->when != b->when)
+	return a->when < b->when;
+    return (int) (a->seq - b->seq) < 0;
+}
+
+//----------------------------------------------------------------------
+// EventQueue::Place
+// 	Put "toOccur" in slot "index" of the heap, and let it know.
+//----------------------------------------------------------------------
+
+void
+EventQueue::Place(PendingInterrupt *toOccur, int index)
+{
+    heap[index] = toOccur;
+    toOccur->index = index;
+}
+
+//----------------------------------------------------------------------
+// EventQueue::SiftUp
+// 	Move the interrupt in slot "index" towards the root, until its
+//	parent is due before it.
+//----------------------------------------------------------------------
+
+void
+EventQueue::SiftUp(int index)
+{
+    PendingInterrupt *toOccur = heap[index];
+    int parent;
+
+    while (index > 0) {
+	parent = (index - 1) / 2;
+	if (!Before(toOccur, heap[parent]))
+	    break;
+	Place(heap[parent], index);
+	index = parent;
+    }
+    Place(toOccur, index);
+}
+
+//----------------------------------------------------------------------
+// EventQueue::SiftDown
+// 	Move the interrupt in slot "index" towards the leaves, until it
+//	is due before both its children.
+//----------------------------------------------------------------------
+
+void
+EventQueue::SiftDown(int index)
+{
+    PendingInterrupt *toOccur = heap[index];
+    int child;
+
+    for (;;) {
+	child = 2 * index + 1;
+	if (child >= numPending)
+	    break;
+	if (child + 1 < numPending && Before(heap[child + 1], heap[child]))
+	    child++;
+	if (!Before(heap[child], toOccur))
+	    break;
+	Place(heap[child], index);
+	index = child;
+    }
+    Place(toOccur, index);
+}
+
+//----------------------------------------------------------------------
+// EventQueue::Insert
+// 	Put "toOccur" in the queue.  It will be taken out after the
+//	interrupts already in the queue that are due at the same time.
+//----------------------------------------------------------------------
+
+void
+EventQueue::Insert(PendingInterrupt *toOccur)
+{
+    if (numPending == size) {
+	PendingInterrupt **bigger = new PendingInterrupt *[2 * size];
+
+	for (int i = 0; i < numPending; i++)
+	    bigger[i] = heap[i];
+	delete [] heap;
+	heap = bigger;
+	size *= 2;
+    }
+    toOccur->seq = nextSeq++;
+    heap[numPending] = toOccur;
+    numPending++;
+    SiftUp(numPending - 1);
+}
+
+//----------------------------------------------------------------------
+// EventQueue::Peek
+// 	Return the interrupt due first, leaving it in the queue, or NULL
+//	if the queue is empty.
+//----------------------------------------------------------------------
+
+PendingInterrupt *
+EventQueue::Peek()
+{
+    if (numPending == 0)
+	return NULL;
+    return heap[0];
+}
+
+//----------------------------------------------------------------------
+// EventQueue::RemoveFirst
+// 	Take the interrupt due first out of the queue, and return it.
+//	Return NULL if the queue is empty.
+//----------------------------------------------------------------------
+
+PendingInterrupt *
+EventQueue::RemoveFirst()
+{
+    PendingInterrupt *first;
+
+    if (numPending == 0)
+	return NULL;
+    first = heap[0];
+    Remove(first);
+    return first;
+}
+
+//----------------------------------------------------------------------
+// EventQueue::Remove
+// 	Take "toOccur", which must be in the queue, out of it.  The last
+//	interrupt of the heap takes its slot, and moves up or down to
+//	where it belongs.
+//----------------------------------------------------------------------
+
+void
+EventQueue::Remove(PendingInterrupt *toOccur)
+{
+    int index = toOccur->index;
+
+    ASSERT(index >= 0 && index < numPending && heap[index] == toOccur);
+    toOccur->index = -1;
+    numPending--;
+    if (index == numPending)
+	return;				// it was the last one
+    Place(heap[numPending], index);
+    if (index > 0 && Before(heap[index], heap[(index - 1) / 2]))
+	SiftUp(index);
+    else
+	SiftDown(index);
+}
+
+//----------------------------------------------------------------------
+// EventQueue::Mapcar
+// 	Apply "func" to every interrupt in the queue, in heap order
+//	(which is not the order in which they are due).
+//----------------------------------------------------------------------
+
+void
+EventQueue::Mapcar(VoidFunctionPtr func)
+{
+    for (int i = 0; i < numPending; i++)
+	(*func)((int) heap[i]);
+}
@@ -0,0 +1,71 @@
+// eventqueue.h
+//	Data structure to keep the interrupts scheduled to occur in the
+//	future, sorted by the time at which they are due.
+//
+//	The queue is a binary heap, kept in an array: inserting or
+//	removing an interrupt costs O(log n), looking at the earliest one
+//	costs O(1).  A sorted list costs O(n) per insertion, which hurts
+//	once many devices (and timers) have interrupts pending.
+//
+//	Interrupts due at the same time are taken out in the order they
+//	were put in, as with List::SortedInsert.
+//
+//	Each interrupt remembers its position in the heap, so that it can
+//	be cancelled before it is due.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef EVENTQUEUE_H
+#define EVENTQUEUE_H
+
+#include "copyright.h"
+#include "utility.h"
+
+class PendingInterrupt;
+
+// The following class defines a queue of pending interrupts.
+
+class EventQueue {
+  public:
+    EventQueue();			// initialize an empty queue
+    ~EventQueue();			// de-allocate the queue, but not
+					// the interrupts still in it
+
+    void Insert(PendingInterrupt *toOccur);
+					// Put an interrupt in the queue,
+					// after those due at the same time
+    PendingInterrupt *Peek();		// Earliest interrupt, left in the
+					// queue; NULL if empty
+    PendingInterrupt *RemoveFirst();	// Take the earliest interrupt out
+					// of the queue; NULL if empty
+    void Remove(PendingInterrupt *toOccur);
+					// Take "toOccur" out of the queue,
+					// wherever it is
+
+    bool IsEmpty() { return numPending == 0; }
+    int NumPending() { return numPending; }
+
+    void Mapcar(VoidFunctionPtr func);	// Apply "func" to every interrupt
+					// in the queue, in no particular
+					// order
+
+  private:
+    PendingInterrupt **heap;		// heap[0] is the earliest interrupt;
+					// heap[i] is due no later than
+					// heap[2i + 1] and heap[2i + 2]
+    int numPending;			// interrupts in the heap
+    int size;				// room in the heap
+    unsigned int nextSeq;		// sequence number of the next
+					// interrupt inserted
+
+    bool Before(PendingInterrupt *a, PendingInterrupt *b);
+					// is "a" due before "b"?
+    void Place(PendingInterrupt *toOccur, int index);
+					// put "toOccur" in slot "index"
+    void SiftUp(int index);		// restore the heap order, after
+    void SiftDown(int index);		// slot "index" changed
+};
+
+#endif // EVENTQUEUE_H
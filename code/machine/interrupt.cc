@@ -23,12 +23,31 @@
 #include "copyright.h"
 #include "interrupt.h"
 #include "system.h"
+#ifdef USER_PROGRAM
+#include "profile.h"
+#endif
+
+#define IdleDelay	20000	// microseconds the host sleeps in Idle,
+				// when only polls are pending but no
+				// host file is watched
 
 // String definitions for debugging messages
 
 static const char *intLevelNames[] = { "off", "on"};
 static const char *intTypeNames[] = { "timer", "disk", "console write", 
-			"console read", "network send", "network recv"};
+			"console read", "network send", "network recv", "alarm"};
+
+//----------------------------------------------------------------------
+// IsPoll
+// 	Return TRUE if interrupts of type "type" only poll a host file
+//	for input: they do something only if input arrived meanwhile.
+//----------------------------------------------------------------------
+
+static bool
+IsPoll(IntType type)
+{
+    return type == ConsoleReadInt || type == NetworkRecvInt;
+}
 
 //----------------------------------------------------------------------
 // PendingInterrupt::PendingInterrupt
@@ -48,6 +67,8 @@ PendingInterrupt::PendingInterrupt(VoidFunctionPtr func, int param, long long ti
     arg = param;
     when = time;
     type = kind;
+    seq = 0;
+    index = -1;
 }
 
 //----------------------------------------------------------------------
@@ -60,10 +81,12 @@ PendingInterrupt::PendingInterrupt(VoidFunctionPtr func, int param, long long ti
 Interrupt::Interrupt()
 {
     level = IntOff;
-    pending = new List();
+    pending = new EventQueue();
     inHandler = FALSE;
     yieldOnReturn = FALSE;
     status = SystemMode;
+    numPolls = 0;
+    numWatched = 0;
 }
 
 //----------------------------------------------------------------------
@@ -74,10 +97,7 @@ Interrupt::Interrupt()
 Interrupt::~Interrupt()
 {
     while (!pending->IsEmpty())
-      // LB: correction 
-      //delete pending->Remove(); 
-       delete (PendingInterrupt *)(pending->Remove());
-    // End of correction 
+	delete pending->RemoveFirst();
     delete pending;
 }
 
@@ -181,6 +201,24 @@ Interrupt::OneTick()
     }
 }
 
+//----------------------------------------------------------------------
+// Interrupt::NextDue
+// 	Return the simulated time at which the earliest pending
+//	interrupt is due, or -1 if nothing is pending.  Until that time,
+//	OneTick has nothing to do but advance the clock, which lets the
+//	machine simulation account user ticks in bulk.
+//----------------------------------------------------------------------
+
+long long
+Interrupt::NextDue()
+{
+    PendingInterrupt *next = pending->Peek();
+
+    if (next == NULL)
+	return -1;
+    return next->when;
+}
+
 //----------------------------------------------------------------------
 // Interrupt::YieldOnReturn
 // 	Called from within an interrupt handler, to cause a context switch
@@ -199,6 +237,24 @@ Interrupt::YieldOnReturn()
     yieldOnReturn = TRUE; 
 }
 
+//----------------------------------------------------------------------
+// Interrupt::YieldSoon
+// 	Cause a context switch in the running thread as soon as
+//	possible: on return from the interrupt handler if we are in
+//	one, otherwise the next time interrupts are enabled, or at the
+//	first user instruction after the system call (Machine::Tick
+//	always calls OneTick after a trap).
+//
+//	Used by the kernel when it makes ready a thread that should run
+//	before the current one.
+//----------------------------------------------------------------------
+
+void
+Interrupt::YieldSoon()
+{
+    yieldOnReturn = TRUE;
+}
+
 //----------------------------------------------------------------------
 // Interrupt::Idle
 // 	Routine called when there is nothing in the ready queue.
@@ -207,6 +263,15 @@ Interrupt::YieldOnReturn()
 //	on the ready queue, the only thing to do is to advance 
 //	simulated time until the next scheduled hardware interrupt.
 //
+//	If all the pending interrupts only poll for input, nothing can
+//	happen until some input arrives: rather than have the host spin
+//	through the polls, we block until one of the watched host files
+//	has input.  (If no file is watched, we just let the host run
+//	something else for a while.)
+//
+//	Threads sleeping for some time (Thread::SleepFor) are woken up
+//	by an alarm interrupt, so the clock jumps straight to it.
+//
 //	If there are no pending interrupts, stop.  There's nothing
 //	more for us to do.
 //----------------------------------------------------------------------
@@ -215,6 +280,10 @@ Interrupt::Idle()
 {
     DEBUG('i', "Machine idling; checking for interrupts.\n");
     status = IdleMode;
+    if (numPolls > 0 && numPolls == pending->NumPending()) {
+	DEBUG('i', "Only polls pending; waiting for input.\n");
+	WaitForInput(watched, numWatched, (numWatched > 0) ? -1 : IdleDelay);
+    }
     if (CheckIfDue(TRUE)) {		// check for any pending interrupts
     	while (CheckIfDue(FALSE))	// check for any other pending 
 	    ;				// interrupts
@@ -236,6 +305,39 @@ Interrupt::Idle()
     Halt();
 }
 
+//----------------------------------------------------------------------
+// Interrupt::WatchInput
+// 	Let Idle wait for input on host file "fd", when there is nothing
+//	else to do than poll it.  Called by the devices that poll for
+//	input, whenever they are ready to accept some.
+//----------------------------------------------------------------------
+
+void
+Interrupt::WatchInput(int fd)
+{
+    for (int i = 0; i < numWatched; i++)
+	if (watched[i] == fd)
+	    return;
+    ASSERT(numWatched < MaxWatchedFiles);
+    watched[numWatched++] = fd;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::UnwatchInput
+// 	Stop waiting for input on host file "fd": the device cannot take
+//	any more for now.
+//----------------------------------------------------------------------
+
+void
+Interrupt::UnwatchInput(int fd)
+{
+    for (int i = 0; i < numWatched; i++)
+	if (watched[i] == fd) {
+	    watched[i] = watched[--numWatched];
+	    return;
+	}
+}
+
 //----------------------------------------------------------------------
 // Interrupt::Halt
 // 	Shut down Nachos cleanly, printing out performance statistics.
@@ -245,6 +347,10 @@ Interrupt::Halt()
 {
     printf("Machine halting!\n\n");
     stats->Print();
+#ifdef USER_PROGRAM
+    if (machine != NULL && machine->profiler != NULL)
+	machine->profiler->Report();
+#endif
     Cleanup();     // Never returns.
 }
 
@@ -253,18 +359,21 @@ Interrupt::Halt()
 // 	Arrange for the CPU to be interrupted when simulated time
 //	reaches "now + when".
 //
-//	Implementation: just put it on a sorted list.
+//	Implementation: just put it in the pending queue (a heap).
 //
 //	NOTE: the Nachos kernel should not call this routine directly.
 //	Instead, it is only called by the hardware device simulators.
 //
+//	Returns a handle on the interrupt, to Cancel it with.  The handle
+//	is only valid until the interrupt handler is called.
+//
 //	"handler" is the procedure to call when the interrupt occurs
 //	"arg" is the argument to pass to the procedure
 //	"fromNow" is how far in the future (in simulated time) the 
 //		 interrupt is to occur
 //	"type" is the hardware device that generated the interrupt
 //----------------------------------------------------------------------
-void
+PendingInterrupt *
 Interrupt::Schedule(VoidFunctionPtr handler, int arg, long long fromNow, IntType type)
 {
     long long when = stats->totalTicks + fromNow;
@@ -274,7 +383,28 @@ Interrupt::Schedule(VoidFunctionPtr handler, int arg, long long fromNow, IntType
 					intTypeNames[type], when);
     ASSERT(fromNow > 0);
 
-    pending->SortedInsert(toOccur, when);
+    if (IsPoll(type))
+	numPolls++;
+    pending->Insert(toOccur);
+    return toOccur;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::Cancel
+// 	Cancel an interrupt scheduled by Schedule, which has not occurred
+//	yet: its handler will not be called.
+//
+//	"toCancel" is the handle that Schedule returned
+//----------------------------------------------------------------------
+void
+Interrupt::Cancel(PendingInterrupt *toCancel)
+{
+    DEBUG('i', "Cancelling interrupt handler the %s at time = %lld\n",
+	  intTypeNames[toCancel->type], toCancel->when);
+    pending->Remove(toCancel);
+    if (IsPoll(toCancel->type))
+	numPolls--;
+    delete toCancel;
 }
 
 //----------------------------------------------------------------------
@@ -300,32 +430,34 @@ Interrupt::CheckIfDue(bool advanceClock)
 					// to invoke an interrupt handler
     if (DebugIsEnabled('i'))
 	DumpState();
-    PendingInterrupt *toOccur = 
-		(PendingInterrupt *)pending->SortedRemove(&when);
+    PendingInterrupt *toOccur = pending->Peek();
 
     if (toOccur == NULL)		// no pending interrupts
 	return FALSE;			
 
+    when = toOccur->when;
     if (advanceClock && when > stats->totalTicks) {	// advance the clock
 	stats->idleTicks += (when - stats->totalTicks);
 	stats->totalTicks = when;
-    } else if (when > stats->totalTicks) {	// not time yet, put it back
-	pending->SortedInsert(toOccur, when);
+    } else if (when > stats->totalTicks) {	// not time yet, leave it
 	return FALSE;
     }
 
 // Check if there is nothing more to do, and if so, quit
     if ((status == IdleMode) && (toOccur->type == TimerInt) 
-				&& pending->IsEmpty()) {
-	 pending->SortedInsert(toOccur, when);
+				&& pending->NumPending() == 1)
 	 return FALSE;
-    }
+    pending->RemoveFirst();
+    if (IsPoll(toOccur->type))
+	numPolls--;
 
     DEBUG('i', "Invoking interrupt handler for the %s at time %d\n", 
 			intTypeNames[toOccur->type], toOccur->when);
 #ifdef USER_PROGRAM
-    if (machine != NULL && status == UserMode)
+    if (machine != NULL && status == UserMode) {
     	machine->DelayedLoad(0, 0);
+	machine->ResetFetch();		// the handler may switch threads
+    }
 #endif
     inHandler = TRUE;
     status = SystemMode;			// whatever we were doing,
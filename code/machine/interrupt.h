@@ -37,6 +37,7 @@
 
 #include "copyright.h"
 #include "list.h"
+#include "eventqueue.h"
 
 // Interrupts can be disabled (IntOff) or enabled (IntOn)
 enum IntStatus { IntOff, IntOn };
@@ -50,7 +51,11 @@ enum MachineStatus {IdleMode, SystemMode, UserMode};
 // In Nachos, we support a hardware timer device, a disk, a console
 // display and keyboard, and a network.
 enum IntType { TimerInt, DiskInt, ConsoleWriteInt, ConsoleReadInt, 
-				NetworkSendInt, NetworkRecvInt};
+				NetworkSendInt, NetworkRecvInt, AlarmInt};
+				// AlarmInt wakes up a sleeping thread
+				// (see Thread::SleepFor)
+
+#define MaxWatchedFiles	4	// host files Idle can wait on
 
 // The following class defines an interrupt that is scheduled
 // to occur in the future.  The internal data structures are
@@ -68,6 +73,10 @@ class PendingInterrupt {
     int arg;                    // The argument to the function.
     long long when;		// When the interrupt is supposed to fire
     IntType type;		// for debugging
+
+    unsigned int seq;		// order of scheduling, to break ties
+    int index;			// slot in the pending queue, -1 once
+				// out of it (see eventqueue.h)
 };
 
 // The following class defines the data structures for the simulation
@@ -91,10 +100,15 @@ class Interrupt {
 					// simulated time forward until the 
 					// next interrupt
 
+    void WatchInput(int fd);		// Idle may wait for input on host
+    void UnwatchInput(int fd);		// file "fd" (see Idle)
+
     void Halt(); 			// quit and print out stats
     
     void YieldOnReturn();		// cause a context switch on return 
 					// from an interrupt handler
+    void YieldSoon();			// cause a context switch the next
+					// time interrupts are enabled
 
     MachineStatus getStatus() { return status; } // idle, kernel, user
     void setStatus(MachineStatus st) { status = st; }
@@ -107,20 +121,30 @@ class Interrupt {
     // but they need to be public since they are called by the
     // hardware device simulators.
 
-    void Schedule(VoidFunctionPtr handler,// Schedule an interrupt to occur
-	int arg, long long when, IntType type);// at time ``when''.  This is called
-    					// by the hardware device simulators.
+    PendingInterrupt *Schedule(VoidFunctionPtr handler,// Schedule an
+	int arg, long long when, IntType type);// interrupt to occur at time
+					// ``when''.  This is called by the
+					// hardware device simulators.
+    void Cancel(PendingInterrupt *toCancel);// Cancel an interrupt that
+					// Schedule returned, before it occurs
     
     void OneTick();       		// Advance simulated time
 
+    long long NextDue();		// Time at which the next pending
+					// interrupt is due, or -1 if none
+
   private:
     IntStatus level;		// are interrupts enabled or disabled?
-    List *pending;		// the list of interrupts scheduled
-				// to occur in the future
+    EventQueue *pending;	// the interrupts scheduled to occur
+				// in the future
     bool inHandler;		// TRUE if we are running an interrupt handler
     bool yieldOnReturn; 	// TRUE if we are to context switch
 				// on return from the interrupt handler
     MachineStatus status;	// idle, kernel mode, user mode
+    int numPolls;		// pending interrupts that only poll
+				// for input (see IsPoll)
+    int watched[MaxWatchedFiles];	// host files polled for input
+    int numWatched;
 
     // these functions are internal to the interrupt simulation code
 
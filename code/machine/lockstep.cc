@@ -0,0 +1,331 @@
+// lockstep.cc -- check the fast engines against the reference switch.
+//
+//   With "-engine lockstep", every user instruction is executed three
+//   times: by the threaded engine, by the micro-op the tiered engine
+//   would use, and -- after undoing the effects of both -- by the
+//   reference switch of mipssim.cc.  The registers (all NumTotalRegs
+//   of them), the stores and the exception raised (if any) must be
+//   identical; at the first difference we print the outcomes, with
+//   the disassembly of the last instructions executed, and abort.
+//
+//   During the check, Machine::RaiseException only records the
+//   exception ("capturing"), and Machine::WriteMem logs each store with
+//   the previous contents of memory.  Once all runs agree, the
+//   exception recorded by the reference run is delivered for real.
+//
+//   "nachos -fuzz <count>" runs the same check on a random stream of
+//   instructions, each with random registers and a random memory, to
+//   cover what the test programs do not (see Machine::Fuzz).
+//
+//   "make lockstep" in the build directory runs every test program
+//   under the lockstep engine.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+
+#include "machine.h"
+#include "mipssim.h"
+#include "decodecache.h"
+#include "system.h"
+
+// Outcome of one run of an instruction.
+
+struct Outcome {
+    int registers[NumTotalRegs];
+    ExceptionType exception;
+    int badVAddr;
+    Machine::StoreRecord stores[2];
+    int numStores;
+};
+
+//----------------------------------------------------------------------
+// Capture
+// 	Record the outcome of the run that just finished.
+//----------------------------------------------------------------------
+
+static void
+Capture(Machine *m, Outcome *out)
+{
+    for (int i = 0; i < NumTotalRegs; i++)
+	out->registers[i] = m->registers[i];
+    out->exception = m->capturedException;
+    out->badVAddr = m->capturedVAddr;
+    out->numStores = m->numStores;
+    for (int i = 0; i < m->numStores; i++)
+	out->stores[i] = m->storeLog[i];
+}
+
+//----------------------------------------------------------------------
+// Undo
+// 	Undo the run that just finished: restore the memory it stored
+//	into, and the registers "saved" before it.
+//----------------------------------------------------------------------
+
+static void
+Undo(Machine *m, int *saved)
+{
+    for (int i = m->numStores - 1; i >= 0; i--)
+	memcpy(&m->mainMemory[m->storeLog[i].physAddr], &m->storeLog[i].before,
+	       m->storeLog[i].size);
+    for (int i = 0; i < NumTotalRegs; i++)
+	m->registers[i] = saved[i];
+}
+
+//----------------------------------------------------------------------
+// Differ
+// 	Compare the outcome of the run of engine "name" with the one of
+//	the reference run; print every difference found.
+//----------------------------------------------------------------------
+
+static bool
+Differ(const char *name, Outcome *a, Outcome *b)
+{
+    bool differ = FALSE;
+
+    for (int i = 0; i < NumTotalRegs; i++)
+	if (a->registers[i] != b->registers[i]) {
+	    printf("\tregister %d: %s 0x%x, switch 0x%x\n", i, name,
+		   a->registers[i], b->registers[i]);
+	    differ = TRUE;
+	}
+    if (a->exception != b->exception || a->badVAddr != b->badVAddr) {
+	printf("\texception: %s %d (0x%x), switch %d (0x%x)\n", name,
+	       a->exception, a->badVAddr, b->exception, b->badVAddr);
+	differ = TRUE;
+    }
+    if (a->numStores != b->numStores) {
+	printf("\tstores: %s %d, switch %d\n", name,
+	       a->numStores, b->numStores);
+	return TRUE;
+    }
+    for (int i = 0; i < a->numStores; i++)
+	if (a->stores[i].physAddr != b->stores[i].physAddr
+	    || a->stores[i].size != b->stores[i].size
+	    || a->stores[i].after != b->stores[i].after) {
+	    printf("\tstore %d: %s %d bytes 0x%x at 0x%x, "
+		   "switch %d bytes 0x%x at 0x%x\n", i, name,
+		   a->stores[i].size, a->stores[i].after, a->stores[i].physAddr,
+		   b->stores[i].size, b->stores[i].after, b->stores[i].physAddr);
+	    differ = TRUE;
+	}
+    return differ;
+}
+
+//----------------------------------------------------------------------
+// Machine::CheckInstruction
+// 	Execute "instr" with every engine, and check that they agree.
+//	Leaves the machine in the state produced by the reference engine;
+//	its exception, if any, is left in capturedException and
+//	capturedVAddr for the caller to deliver.
+//----------------------------------------------------------------------
+
+void
+Machine::CheckInstruction(Instruction *instr)
+{
+    int saved[NumTotalRegs];
+    Outcome threaded, micro, reference;
+    bool differ;
+
+    for (int i = 0; i < NumTotalRegs; i++)
+	saved[i] = registers[i];
+    lockstepPCs[lockstepCount % LockstepHistory] = registers[PCReg];
+    lockstepInstrs[lockstepCount % LockstepHistory] = *instr;
+    lockstepCount++;
+
+    capturing = TRUE;
+
+    // First run: the threaded engine, whose effects we then undo.
+    capturedException = NoException;
+    capturedVAddr = 0;
+    numStores = 0;
+    ExecuteThreaded(instr, FALSE);
+    Capture(this, &threaded);
+    Undo(this, saved);
+
+    // Second run: the micro-op of the tiered engine, undone as well.
+    capturedException = NoException;
+    capturedVAddr = 0;
+    numStores = 0;
+    (*SelectMicroOp(instr))(this, instr);
+    Capture(this, &micro);
+    Undo(this, saved);
+
+    // Last run: the reference switch, whose effects we keep.
+    capturedException = NoException;
+    capturedVAddr = 0;
+    numStores = 0;
+    ExecuteInstruction(instr);
+    Capture(this, &reference);
+    capturing = FALSE;
+
+    differ = Differ("threaded", &threaded, &reference);
+    if (Differ("micro-op", &micro, &reference))
+	differ = TRUE;
+    if (differ)
+	Diverged(saved);
+}
+
+//----------------------------------------------------------------------
+// Machine::Diverged
+// 	Report a difference found by CheckInstruction, with the state
+//	before the instruction ("saved") and the disassembly of the last
+//	instructions checked, then abort.
+//----------------------------------------------------------------------
+
+void
+Machine::Diverged(int *saved)
+{
+    char buf[60];
+    int first, slot;
+
+    printf("Lockstep mismatch at PC = 0x%x, time %lld, after %d "
+	   "instructions checked\n", saved[PCReg], stats->totalTicks,
+	   lockstepCount - 1);
+    printf("Registers before the instruction:\n");
+    for (int i = 0; i < NumTotalRegs; i++)
+	printf("\tr%d\t0x%x%s", i, saved[i], (i % 4) == 3 ? "\n" : "");
+    printf("Last instructions:\n");
+    first = (lockstepCount > LockstepHistory) ?
+	lockstepCount - LockstepHistory : 0;
+    for (int i = first; i < lockstepCount; i++) {
+	slot = i % LockstepHistory;
+	lockstepInstrs[slot].Disassemble(buf);
+	printf("%s 0x%8.8x: %s\n", (i == lockstepCount - 1) ? "=>" : "  ",
+	       lockstepPCs[slot], buf);
+    }
+    fflush(stdout);
+    Abort();
+}
+
+//----------------------------------------------------------------------
+// Machine::LockstepInstruction
+// 	Execute "instr" with every engine, and check that they agree.
+//	Leaves the machine in the state produced by the reference engine,
+//	and delivers its exception, if any, to the kernel.
+//----------------------------------------------------------------------
+
+void
+Machine::LockstepInstruction(Instruction *instr)
+{
+    CheckInstruction(instr);
+    if (capturedException != NoException)
+	RaiseException(capturedException, capturedVAddr);
+}
+
+//----------------------------------------------------------------------
+// RandomWord
+// 	Return 32 random bits (Random gives less).
+//----------------------------------------------------------------------
+
+static unsigned int
+RandomWord()
+{
+    return ((unsigned int) Random() << 16) ^ (unsigned int) Random();
+}
+
+//----------------------------------------------------------------------
+// RandomInstruction
+// 	Return a random instruction word, biased towards the opcodes the
+//	simulator implements: a third of them are SPECIAL (one major
+//	opcode out of 64 otherwise), and a third avoid the reserved and
+//	unimplemented major opcodes.
+//----------------------------------------------------------------------
+
+static unsigned int
+RandomInstruction()
+{
+    unsigned int word = RandomWord();
+    int op;
+
+    switch (Random() % 3) {
+      case 0:
+	return word & 0x03ffffff;		// SPECIAL
+      case 1:
+	return word;
+      default:
+	do {
+	    word = RandomWord();
+	    op = opTable[word >> 26].opCode;
+	} while (op == OP_RES || op == OP_UNIMP);
+	return word;
+    }
+}
+
+//----------------------------------------------------------------------
+// Machine::Fuzz
+// 	Check "count" random instructions with CheckInstruction, each
+//	one from a random machine state.  Must be called before any user
+//	program runs: it overwrites all of physical memory and installs
+//	its own page table.
+//
+//	Memory is mapped one to one, except for a few invalid and
+//	read-only pages, so that faults get exercised too.  The base
+//	register of the instruction points into memory most of the
+//	time, so that loads and stores mostly succeed.  The exceptions
+//	raised are only compared, never delivered.
+//
+//	LWL, LWR, SWL and SWR always get an aligned address: the
+//	simulator asserts that they do.
+//----------------------------------------------------------------------
+
+void
+Machine::Fuzz(int count)
+{
+    TranslationEntry *table = new TranslationEntry[NumPhysPages];
+    TranslationEntry *oldTable = pageTable;
+    unsigned int oldSize = pageTableSize;
+    Instruction instr;
+    int i, traps = 0;
+
+    for (i = 0; i < NumPhysPages; i++) {
+	table[i].virtualPage = i;
+	table[i].physicalPage = i;
+	table[i].valid = (Random() % 16) != 0;
+	table[i].readOnly = (Random() % 16) == 0;
+	table[i].use = FALSE;
+	table[i].dirty = FALSE;
+    }
+    for (i = 0; i < MemorySize; i++)
+	mainMemory[i] = Random();
+    decodeCache->InvalidateAll();
+    pageTable = table;
+    pageTableSize = NumPhysPages;
+    FlushTranslationCache();
+
+    for (i = 0; i < count; i++) {
+	instr.Decode(RandomInstruction());
+
+	for (int r = 0; r < NumTotalRegs; r++)
+	    registers[r] = RandomWord();
+	if (Random() % 4 != 0)
+	    registers[instr.rs] = Random() % MemorySize;
+	registers[PCReg] = (Random() % MemorySize) & ~3;
+	registers[NextPCReg] = registers[PCReg] + 4;
+	registers[LoadReg] = (Random() % 4 == 0) ? Random() % NumGPRegs : 0;
+	registers[BadVAddrReg] = 0;
+	registers[0] = 0;
+	switch (instr.opCode) {
+	  case OP_LWL:			// the simulator only supports
+	  case OP_LWR:			// them aligned (see mipssim.cc)
+	  case OP_SWL:
+	  case OP_SWR:
+	    instr.extra &= ~0x3;
+	    registers[instr.rs] &= ~0x3;
+	    break;
+	}
+
+	CheckInstruction(&instr);
+	if (capturedException != NoException)
+	    traps++;
+    }
+    printf("Fuzzing: %d random instructions checked, %d trapped\n",
+	   count, traps);
+
+    pageTable = oldTable;
+    pageTableSize = oldSize;
+    FlushTranslationCache();
+    delete [] table;
+}
@@ -9,6 +9,8 @@
 
 #include "copyright.h"
 #include "machine.h"
+#include "decodecache.h"
+#include "profile.h"
 #include "system.h"
 //#include "frameprovider.h"
 
@@ -78,6 +80,28 @@ Machine::Machine(bool debug)
     processNumber = 0;
     semProcessNumber = new Semaphore("semProcessNumber", 1);
 
+    decodeCache = new DecodeCache(NumPhysPages);
+    fetchNext = NULL;
+    fetchLeft = 0;
+    fetchPC = 0;
+    fetchFrame = -1;
+
+    // The translation cache would hide most DEBUG('a') messages
+    cacheTranslations = !DebugIsEnabled('a');
+    FlushTranslationCache();
+
+    engine = DefaultEngine;
+
+    // Tracing interrupts prints every tick: no batching then
+    batchTicks = !DebugIsEnabled('i');
+    tickBudget = 0;
+    pendingTicks = 0;
+    capturing = FALSE;
+    numStores = 0;
+    lockstepCount = 0;
+    trapCount = 0;
+    profiler = NULL;
+
 		singleStep = debug;
     CheckEndian();
 }
@@ -109,6 +133,9 @@ Machine::deleteProcess(){
 Machine::~Machine()
 {
     delete [] mainMemory;
+    delete decodeCache;
+    if (profiler != NULL)
+	delete profiler;
     if (tlb != NULL)
         delete [] tlb;
 		//delete frameProviderProcs;
@@ -129,12 +156,99 @@ Machine::RaiseException(ExceptionType which, int badVAddr)
 {
     DEBUG('m', "Exception: %s\n", exceptionNames[which]);
 
-//  ASSERT(interrupt->getStatus() == UserMode);
+    if (capturing) {			// lockstep check in progress: just
+					// remember what should happen
+	if (capturedException == NoException) {
+	    capturedException = which;
+	    capturedVAddr = badVAddr;
+	}
+	return;
+    }
+
+    MachineStatus oldStatus = interrupt->getStatus();
+
+    SyncTicks();			// the kernel must see the right time
+    trapCount++;
     registers[BadVAddrReg] = badVAddr;
     DelayedLoad(0, 0);			// finish anything in progress
+    ResetFetch();			// the kernel may change the PC,
+    FlushTranslationCache();		// the page table or the TLB
     interrupt->setStatus(SystemMode);
     ExceptionHandler(which);		// interrupts are enabled at this point
-    interrupt->setStatus(UserMode);
+    FlushTranslationCache();		// in case the handler edited them
+    tickBudget = 0;			// or scheduled an interrupt
+    interrupt->setStatus(oldStatus);	// UserMode, or SystemMode if a
+					// Copy routine faulted
+}
+
+//----------------------------------------------------------------------
+// Machine::SyncTicks
+// 	Add the user ticks accounted in bulk by Tick to the statistics.
+//----------------------------------------------------------------------
+
+void
+Machine::SyncTicks()
+{
+    stats->totalTicks += pendingTicks * UserTick;
+    stats->userTicks += pendingTicks * UserTick;
+    pendingTicks = 0;
+}
+
+#define MaxTickBudget	0x3fffffff	// when nothing is due soon
+
+//----------------------------------------------------------------------
+// Machine::SlowTick
+// 	Called by Tick when the budget of silent ticks is exhausted: an
+//	interrupt may be due at the end of this tick.  Account for the
+//	pending ticks, let Interrupt::OneTick advance the clock and fire
+//	the interrupts, then compute how many of the following ticks
+//	cannot possibly fire anything.
+//
+//	As long as the clock is strictly before the "when" of the first
+//	pending interrupt, OneTick only adds UserTick to the counters;
+//	interrupts can only be scheduled by the kernel or by interrupt
+//	handlers, and both reset the budget: on the way out of
+//	RaiseException or of OneTick, or, for a thread that starts
+//	running user code from the kernel, in Machine::Run.  Simulated
+//	time is thus exactly the same as with one OneTick per
+//	instruction.
+//----------------------------------------------------------------------
+
+void
+Machine::SlowTick()
+{
+    long long next;
+
+    SyncTicks();
+    interrupt->OneTick();
+
+    tickBudget = 0;
+    if (!batchTicks || singleStep)	// the debugger wants exact time
+	return;
+    next = interrupt->NextDue();
+    if (next < 0 || next - stats->totalTicks > MaxTickBudget)
+	tickBudget = MaxTickBudget;
+    else if (next - 1 - stats->totalTicks > 0)
+	tickBudget = (int) ((next - 1 - stats->totalTicks) / UserTick);
+}
+
+//----------------------------------------------------------------------
+// Machine::InvalidateCode
+// 	Drop the decoded copy of physical "frame", because its contents
+//	are about to be modified (by a user store, by the kernel, or
+//	because the frame is being handed to another address space).
+//----------------------------------------------------------------------
+
+void
+Machine::InvalidateCode(int frame)
+{
+    if (!decodeCache->IsDecoded(frame))
+	return;
+    decodeCache->Invalidate(frame);
+    if (frame == fetchFrame) {
+	ResetFetch();
+	fetchFrame = -1;		// tells RunMicroOps to stop
+    }
 }
 
 //----------------------------------------------------------------------
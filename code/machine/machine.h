@@ -38,6 +38,10 @@
 #define NumPhysPages    128
 #define MemorySize 	(NumPhysPages * PageSize)
 #define TLBSize		4		// if there is a TLB, make it small
+#define LockstepHistory	8		// instructions shown on a
+					// lockstep mismatch
+#define TransCacheSize	32		// entries in the host-side
+					// translation cache (power of 2)
 
 enum ExceptionType { NoException,           // Everything ok!
 		     SyscallException,      // A program executed a system call.
@@ -55,6 +59,26 @@ enum ExceptionType { NoException,           // Everything ok!
 		     NumExceptionTypes
 };
 
+// The execution engines available to run user instructions:
+//	SwitchEngine -- the reference interpreter, one big switch per
+//	  instruction (mipssim.cc)
+//	ThreadedEngine -- handlers chained with computed gotos, each
+//	  handler jumping directly to the next one (threadedsim.cc)
+//	LockstepEngine -- run every instruction through the threaded
+//	  engine, the micro-ops of the tiered engine and the switch, and
+//	  stop at the first difference (lockstep.cc)
+//	TieredEngine -- interpret with the switch, but run hot blocks
+//	  as chains of specialized micro-ops (tiered.cc)
+
+enum EngineType { SwitchEngine, ThreadedEngine, LockstepEngine,
+		  TieredEngine };
+
+#ifdef SWITCH_ENGINE
+#define DefaultEngine	SwitchEngine
+#else
+#define DefaultEngine	ThreadedEngine
+#endif
+
 // User program CPU state.  The full set of MIPS registers, plus a few
 // more because we need to be able to start/stop a user program between
 // any two instructions (thus we need to keep track of things like load
@@ -62,6 +86,8 @@ enum ExceptionType { NoException,           // Everything ok!
 
 class Semaphore;
 class FrameProvider;
+class DecodeCache;
+class Profiler;
 
 #define StackReg	29	// User's stack pointer
 #define RetAddrReg	31	// Holds return address for procedure calls
@@ -76,18 +102,23 @@ class FrameProvider;
 #define BadVAddrReg	39	// The failing virtual address on an exception
 #define NumTotalRegs 	40
 
-// The following class defines an instruction, represented in both
-// 	undecoded binary form
-//      decoded to identify
+// The following class defines an instruction, decoded to identify
 //	    operation to do
 //	    registers to act on
 //	    any immediate operand value
+//
+// The binary form is not kept: decoded instructions are cached for
+// every page of code (see decodecache.h), so they are packed into
+// 8 bytes, twice the size of the binary form.
 
 class Instruction {
   public:
-    void Decode();	// decode the binary representation of the instruction
-
-    unsigned int value; // binary representation of the instruction
+    void Decode(unsigned int value);
+			// decode the binary representation of the
+			// instruction, "value"
+    void Disassemble(char *buffer);
+			// print the instruction into "buffer" (at
+			// least 40 characters)
 
    unsigned char opCode;     // Type of instruction.  This is NOT the same as the
     		     // opcode field from the instruction: see defs in mips.h
@@ -96,6 +127,26 @@ class Instruction {
                      // Immediates are sign-extended.
 };
 
+// Fail to compile if Instruction is not packed as intended.
+typedef char InstructionIsPacked[(sizeof(Instruction) == 8) ? 1 : -1];
+
+// The following structure defines one entry of the translation cache:
+// a host-side, direct-mapped memo of the last successful translation
+// of a virtual page, so that ReadMem and WriteMem can skip Translate
+// on the common path.  It is NOT part of the simulated hardware: the
+// kernel never sees it, and the "use" and "dirty" bits of the real
+// page table or TLB entry are still set on every access.
+
+struct TranslationCacheEntry {
+    unsigned int vpn;		// virtual page cached here, or
+				// InvalidVPN
+    int frameBase;		// physical address of the page
+    TranslationEntry *entry;	// where to set the use/dirty bits
+    bool readOnly;		// writes must go the slow way
+};
+
+#define InvalidVPN	((unsigned int) -1)
+
 // The following class defines the simulated host workstation hardware, as
 // seen by user programs -- the CPU registers, main memory, etc.
 // User programs shouldn't be able to tell that they are running on our
@@ -118,16 +169,49 @@ class Machine {
 // Routines callable by the Nachos kernel
     void Run();	 		// Run a user program
 
+    EngineType engine;		// which engine Run() uses
+
+    int trapCount;		// number of traps into the kernel so far
+
+    Profiler *profiler;		// counts user instructions, if not NULL
+
     int ReadRegister(int num);	// read the contents of a CPU register
 
     void WriteRegister(int num, int value);
 				// store a value into a CPU register
 
+    bool CopyFromUser(int virtAddr, char *buffer, int size);
+    bool CopyToUser(int virtAddr, const char *buffer, int size);
+				// Copy "size" bytes between user virtual
+				// memory and a kernel buffer.  Return
+				// FALSE if some page could not be
+				// translated.
+    int CopyStringFromUser(int virtAddr, char *buffer, int size);
+				// Same, but stop after the first NUL.
+				// Return the length of the string, or
+				// -1 on failure.
 
 // Routines internal to the machine simulation -- DO NOT call these
 
     void OneInstruction(Instruction *instr);
     				// Run one instruction of a user program.
+    Instruction *FetchInstruction();
+				// Return the decoded instruction at the
+				// PC, or NULL if the fetch trapped.
+    void ExecuteInstruction(Instruction *instr);
+				// Execute an already decoded instruction.
+    void ExecuteThreaded(Instruction *instr, bool chain);
+				// Same, with the threaded engine.  If
+				// "chain", keep running the following
+				// instructions; never returns.
+    void LockstepInstruction(Instruction *instr);
+				// Execute an instruction with every engine,
+				// checking that they agree.
+    void CheckInstruction(Instruction *instr);
+				// Same, but leave the exception raised, if
+				// any, in capturedException.
+    void Fuzz(int count);	// Check "count" random instructions, in
+				// random machine states.
     void DelayedLoad(int nextReg, int nextVal);
 				// Do a pending delayed load (modifying a reg)
 
@@ -148,6 +232,29 @@ class Machine {
 				// Trap to the Nachos kernel, because of a
 				// system call or other exception.
 
+    void Tick() {		// Account for one user instruction
+	if (tickBudget > 0) {
+	    tickBudget--;
+	    pendingTicks++;
+	} else
+	    SlowTick();
+    }
+    void SyncTicks();		// Add the ticks not yet accounted for to
+				// the statistics.  Done before entering
+				// the kernel, which may look at the time.
+    void ResetFetch() { fetchLeft = 0; }
+				// Forget the current block, so that the
+				// next fetch translates the PC again.
+				// Called whenever the PC, the page table
+				// or the TLB may have changed under us.
+    void FlushTranslationCache();
+				// Forget all cached translations.  Must
+				// be called whenever the page table or
+				// the TLB is modified or switched.
+    void InvalidateCode(int frame);
+				// The contents of physical "frame" are
+				// about to change: drop its decoded copy.
+
     void Debugger();		// invoke the user program debugger
     void DumpState();		// print the user CPU and memory state
 
@@ -192,12 +299,65 @@ class Machine {
     void newProcess();
     void deleteProcess();
 
+// State of the lockstep comparison.  While "capturing", exceptions are
+// recorded instead of being delivered to the kernel, and every store
+// is logged with the old contents of memory so that it can be undone.
+
+    struct StoreRecord {
+	int physAddr;		// where the store went
+	int size;		// 1, 2 or 4 bytes
+	unsigned int before;	// raw memory contents before the store
+	unsigned int after;	// and after
+    };
+
+    bool capturing;		// recording instead of trapping?
+    ExceptionType capturedException;	// first exception raised
+    int capturedVAddr;		// and its bad virtual address
+    StoreRecord storeLog[2];	// stores done by the instruction
+    int numStores;
+
+    int lockstepCount;		// instructions checked so far
+    int lockstepPCs[LockstepHistory];	// the last ones checked, and
+    Instruction lockstepInstrs[LockstepHistory];	// their PCs
+
   private:
     bool singleStep;		// drop back into the debugger after each
 				// simulated instruction
     int runUntilTime;		// drop back into the debugger when simulated
 				// time reaches this value
     int processNumber;
+
+    void RunTiered();		// Execution loop of the tiered engine
+    void RunMicroOps(Instruction *head, int len);
+				// Run a hot block through its micro-ops
+    Instruction *NextThreaded();	// Advance the clock and fetch the next
+				// instruction, for the threaded engine
+    void TraceInstruction(Instruction *instr);
+				// Print "instr" for DEBUG('m')
+    void Diverged(int *saved);	// Report a lockstep mismatch and abort
+
+    void SlowTick();		// Really call Interrupt::OneTick
+    int tickBudget;		// user ticks that can still elapse before
+				// the next interrupt may be due
+    int pendingTicks;		// user ticks elapsed but not yet added
+				// to the statistics
+    bool batchTicks;		// FALSE when tracing interrupts
+
+    bool TranslateSpan(int virtAddr, int *physAddr, int *size,
+		       bool writing);
+				// Translate the part of a span that lies
+				// in its first page, for the Copy routines
+    void CacheTranslation(int virtAddr, int physAddr, bool writing);
+				// Remember a translation that succeeded
+    bool cacheTranslations;	// FALSE when tracing translations
+    TranslationCacheEntry transCache[TransCacheSize];
+
+    DecodeCache *decodeCache;	// predecoded user instructions, by frame
+    Instruction *fetchNext;	// next decoded instruction in the block
+				// being executed
+    int fetchLeft;		// instructions left in that block
+    int fetchPC;		// virtual address of fetchNext
+    int fetchFrame;		// physical frame holding that block
 };
 
 extern void ExceptionHandler(ExceptionType which);
@@ -14,15 +14,19 @@
 
 #include "machine.h"
 #include "mipssim.h"
+#include "decodecache.h"
+#include "profile.h"
 #include "system.h"
 
-static void Mult(int a, int b, bool signedArith, int* hiPtr, int* loPtr);
-
 //----------------------------------------------------------------------
 // Machine::Run
 // 	Simulate the execution of a user-level program on Nachos.
 //	Called by the kernel when the program starts up; never returns.
 //
+//	The instructions are executed by the engine selected with
+//	"-engine": the reference switch below, the threaded engine,
+//	both in lockstep, or the tiered engine.
+//
 //	This routine is re-entrant, in that it can be called multiple
 //	times concurrently -- one for each thread executing user code.
 //----------------------------------------------------------------------
@@ -33,9 +37,12 @@ Machine::Run()
   // LB: Using a dynamic instr is right here as one never exits this
   // function.
   // Instruction *instr = new Instruction;  // storage for decoded instruction
-  Instruction the_instr;
-  Instruction *instr = &the_instr;
+  // Instruction the_instr;
+  // Instruction *instr = &the_instr;
   // End of Modification
+  // Instructions are now decoded once and kept in the decode cache:
+  // see FetchInstruction.
+  Instruction *instr;
 
     if(DebugIsEnabled('m'))
 
@@ -48,9 +55,24 @@ Machine::Run()
     // End of correction
 
     interrupt->setStatus(UserMode);
+    ResetFetch();
+    tickBudget = 0;		// we may come from the handler of another
+				// thread, which left its own budget
+    if (engine == ThreadedEngine)
+	ExecuteThreaded(FetchInstruction(), TRUE);	// never returns
+    if (engine == TieredEngine)
+	RunTiered();					// never returns
     for (;;) {
-        OneInstruction(instr);
-	interrupt->OneTick();
+	instr = FetchInstruction();
+	if (instr == NULL)		// the fetch trapped
+	    ;
+	else if (engine == LockstepEngine)
+	    LockstepInstruction(instr);
+	else
+	    ExecuteInstruction(instr);
+	Tick();				// normally just counts; calls
+					// interrupt->OneTick() when an
+					// interrupt may be due
 	if (singleStep && (runUntilTime <= stats->totalTicks))
 	  Debugger();
     }
@@ -79,6 +101,36 @@ TypeToReg(RegType reg, Instruction *instr)
     }
 }
 
+//----------------------------------------------------------------------
+// Instruction::Disassemble
+// 	Print the instruction into "buffer", in the format of opStrings.
+//----------------------------------------------------------------------
+
+void
+Instruction::Disassemble(char *buffer)
+{
+    const struct OpString *str = &opStrings[opCode];
+
+    ASSERT(opCode <= MaxOpcode);
+    sprintf(buffer, str->string, TypeToReg(str->args[0], this), 
+	    TypeToReg(str->args[1], this), TypeToReg(str->args[2], this));
+}
+
+//----------------------------------------------------------------------
+// Machine::TraceInstruction
+// 	Print the instruction about to be executed at the PC, for
+//	debugging.  Shared by all the execution engines.
+//----------------------------------------------------------------------
+
+void
+Machine::TraceInstruction(Instruction *instr)
+{
+    char buffer[60];
+
+    instr->Disassemble(buffer);
+    printf("At PC = 0x%x: %s\n", registers[PCReg], buffer);
+}
+
 //----------------------------------------------------------------------
 // Machine::OneInstruction
 // 	Execute one instruction from a user-level program
@@ -106,25 +158,82 @@ void
 Machine::OneInstruction(Instruction *instr)
 {
     int raw;
-    int nextLoadReg = 0; 	
-    int nextLoadValue = 0; 	// record delayed load operation, to apply
-				// in the future
 
     // Fetch instruction 
     if (!machine->ReadMem(registers[PCReg], 4, &raw))
 	return;			// exception occurred
-    instr->value = raw;
-    instr->Decode();
-
-    if (DebugIsEnabled('m')) {
-       struct OpString *str = &opStrings[instr->opCode];
-
-       ASSERT(instr->opCode <= MaxOpcode);
-       printf("At PC = 0x%x: ", registers[PCReg]);
-       printf(str->string, TypeToReg(str->args[0], instr), 
-		TypeToReg(str->args[1], instr), TypeToReg(str->args[2], instr));
-       printf("\n");
-       }
+    instr->Decode(raw);
+    ExecuteInstruction(instr);
+}
+
+//----------------------------------------------------------------------
+// Machine::FetchInstruction
+// 	Return the decoded instruction at the current PC, or NULL if
+//	the fetch raised an exception (which has then already been
+//	handled).
+//
+//	As long as the PC keeps following the block we fetched last
+//	time, the next decoded instruction is returned directly,
+//	without translating the PC nor decoding anything.  Otherwise
+//	the PC is translated once, and the decode cache gives us the
+//	block starting at the physical address found.
+//
+//	Anything that may break the straight-line assumption (an
+//	exception, an interrupt, a context switch, a write into the
+//	code) calls ResetFetch, so the cursor is never used stale.
+//
+//	Every engine fetches through here, so this is also where the
+//	profiler, if any, counts instructions.
+//----------------------------------------------------------------------
+
+Instruction *
+Machine::FetchInstruction()
+{
+    int pc = registers[PCReg];
+    int physAddr, len;
+    ExceptionType exception;
+    Instruction *instr;
+
+    if (fetchLeft > 0 && pc == fetchPC) {
+	fetchLeft--;
+	fetchPC += 4;
+	instr = fetchNext++;
+    } else {
+	DEBUG('a', "Fetching VA 0x%x\n", pc);
+	exception = Translate(pc, &physAddr, 4, FALSE);
+	if (exception != NoException) {
+	    RaiseException(exception, pc);
+	    return NULL;
+	}
+	fetchFrame = physAddr / PageSize;
+	instr = decodeCache->Lookup(fetchFrame, (physAddr % PageSize) / 4,
+				    &len);
+	fetchNext = instr + 1;
+	fetchLeft = len - 1;
+	fetchPC = pc + 4;
+    }
+    if (profiler != NULL)
+	profiler->Count(pc, instr);
+    return instr;
+}
+
+//----------------------------------------------------------------------
+// Machine::ExecuteInstruction
+// 	Execute one already decoded instruction.  The decoded
+//	instruction is only read, so it can live in the decode cache.
+//
+//	See OneInstruction for how exceptions are dealt with.
+//----------------------------------------------------------------------
+
+void
+Machine::ExecuteInstruction(Instruction *instr)
+{
+    int nextLoadReg = 0; 	
+    int nextLoadValue = 0; 	// record delayed load operation, to apply
+				// in the future
+
+    if (DebugIsEnabled('m'))
+	TraceInstruction(instr);
     
     // Compute next pc, but don't install in case there's an error or branch.
     int pcAfter = registers[NextPCReg] + 4;
@@ -211,6 +320,10 @@ Machine::OneInstruction(Instruction *instr)
 	if (registers[instr->rt] == 0) {
 	    registers[LoReg] = 0;
 	    registers[HiReg] = 0;
+	} else if (registers[instr->rt] == -1) {	// the host may trap on
+	    registers[LoReg] =				// 0x80000000 / -1
+		(int) (0 - (unsigned int) registers[instr->rs]);
+	    registers[HiReg] = 0;
 	} else {
 	    registers[LoReg] =  registers[instr->rs] / registers[instr->rt];
 	    registers[HiReg] = registers[instr->rs] % registers[instr->rt];
@@ -637,48 +750,111 @@ Machine::DelayedLoad(int nextReg, int nextValue)
     registers[0] = 0; 	// and always make sure R0 stays zero.
 }
 
+// The decode table merges opTable, specialTable and the BCOND cases
+// into a single table, so that decoding is two lookups and no test.
+// The major opcode (bits 31:26) selects a slice of the table, and a
+// field of the instruction (none, "funct" for SPECIAL, "rt" for BCOND)
+// the entry within the slice.  The entry gives the opcode and where to
+// find "extra".
+//
+// The table is computed at compile time by compilers that support it
+// (see DECODE_CONSTEXPR in mipssim.h), and when Nachos starts otherwise.
+
+#define DecodeSpecial	64		// SPECIAL slice: 64 "funct" values
+#define DecodeBcond	(64 + 64)	// BCOND slice: 32 "rt" values
+#define DecodeEntries	(64 + 64 + 32)
+
+struct DecodeSelect {
+    unsigned char base;		// first entry of the slice
+    unsigned char shift;	// position of the field selecting the entry
+    unsigned char mask;		// and its width (0: slice of one entry)
+};
+
+struct DecodeEntry {
+    unsigned char opCode;	// as in mips.h
+    unsigned char shift;	// position of "extra" in the instruction
+    int mask;			// and its width
+    int sign;			// its sign bit, if it is sign-extended
+};
+
+class DecodeTable {
+  public:
+    DECODE_CONSTEXPR DecodeTable();
+
+    DecodeSelect select[64];	// by major opcode
+    DecodeEntry entry[DecodeEntries];
+
+  private:
+    DECODE_CONSTEXPR void Set(int i, int opCode, int format);
+};
+
+//----------------------------------------------------------------------
+// DecodeTable::Set
+// 	Fill entry "i" for an instruction "opCode" of type "format".
+//----------------------------------------------------------------------
+
+DECODE_CONSTEXPR void
+DecodeTable::Set(int i, int opCode, int format)
+{
+    entry[i].opCode = opCode;
+    entry[i].shift = (format == RFMT) ? 6 : 0;
+    entry[i].mask = (format == IFMT) ? 0xffff
+		  : (format == RFMT) ? 0x1f : 0x3ffffff;
+    entry[i].sign = (format == IFMT) ? 0x8000 : 0;
+}
+
+//----------------------------------------------------------------------
+// DecodeTable::DecodeTable
+// 	Build the decode table from opTable and specialTable.
+//----------------------------------------------------------------------
+
+DECODE_CONSTEXPR
+DecodeTable::DecodeTable() : select(), entry()
+{
+    for (int op = 0; op < 64; op++) {
+	select[op].base = op;
+	select[op].shift = 0;
+	select[op].mask = 0;
+	Set(op, opTable[op].opCode, opTable[op].format);
+    }
+
+    select[0].base = DecodeSpecial;	// SPECIAL: by "funct"
+    select[0].mask = 0x3f;
+    for (int funct = 0; funct < 64; funct++)
+	Set(DecodeSpecial + funct, specialTable[funct], RFMT);
+
+    select[1].base = DecodeBcond;	// BCOND: by "rt"
+    select[1].shift = 16;
+    select[1].mask = 0x1f;
+    for (int rt = 0; rt < 32; rt++)
+	Set(DecodeBcond + rt, OP_UNIMP, IFMT);
+    Set(DecodeBcond + 0x00, OP_BLTZ, IFMT);
+    Set(DecodeBcond + 0x01, OP_BGEZ, IFMT);
+    Set(DecodeBcond + 0x10, OP_BLTZAL, IFMT);
+    Set(DecodeBcond + 0x11, OP_BGEZAL, IFMT);
+}
+
+static DECODE_CONSTEXPR DecodeTable decodeTable;
+
 //----------------------------------------------------------------------
 // Instruction::Decode
-// 	Decode a MIPS instruction 
+// 	Decode a MIPS instruction.  Immediates are sign-extended by
+//	flipping, then subtracting, their sign bit.
 //----------------------------------------------------------------------
 
 void
-Instruction::Decode()
+Instruction::Decode(unsigned int value)
 {
-    OpInfo *opPtr;
+    const DecodeSelect *select = &decodeTable.select[value >> 26];
+    const DecodeEntry *entry = &decodeTable.entry[select->base +
+				((value >> select->shift) & select->mask)];
     
     rs = (value >> 21) & 0x1f;
     rt = (value >> 16) & 0x1f;
     rd = (value >> 11) & 0x1f;
-    opPtr = &opTable[(value >> 26) & 0x3f];
-    opCode = opPtr->opCode;
-    if (opPtr->format == IFMT) {
-	extra = value & 0xffff;
-	if (extra & 0x8000) {
-    	   extra |= 0xffff0000;
-	}
-    } else if (opPtr->format == RFMT) {
-	extra = (value >> 6) & 0x1f;
-    } else {
-	extra = value & 0x3ffffff;
-    }
-    if (opCode == SPECIAL) {
-	opCode = specialTable[value & 0x3f];
-    } else if (opCode == BCOND) {
-	int i = value & 0x1f0000;
-
-	if (i == 0) {
-    	    opCode = OP_BLTZ;
-	} else if (i == 0x10000) {
-    	    opCode = OP_BGEZ;
-	} else if (i == 0x100000) {
-    	    opCode = OP_BLTZAL;
-	} else if (i == 0x110000) {
-    	    opCode = OP_BGEZAL;
-	} else {
-    	    opCode = OP_UNIMP;
-	}
-    }
+    opCode = entry->opCode;
+    extra = ((int) ((value >> entry->shift) & entry->mask) ^ entry->sign)
+	- entry->sign;
 }
 
 //----------------------------------------------------------------------
@@ -688,7 +864,7 @@ Instruction::Decode()
 // 	double-length result of the multiplication.
 //----------------------------------------------------------------------
 
-static void
+void
 Mult(int a, int b, bool signedArith, int* hiPtr, int* loPtr)
 {
     if ((a == 0) || (b == 0)) {
@@ -96,6 +96,10 @@
 #define SIGN_BIT	0x80000000
 #define R31		31
 
+// Multiplication helper, shared by the execution engines.
+
+extern void Mult(int a, int b, bool signedArith, int* hiPtr, int* loPtr);
+
 /*
  * The table below is used to translate bits 31:26 of the instruction
  * into a value suitable for the "opCode" field of a MemWord structure,
@@ -114,7 +118,19 @@ struct OpInfo {
     int format;		/* Format type (IFMT or JFMT or RFMT) */
 };
 
-static OpInfo opTable[] = {
+/*
+ * The decoding tables are turned into a single table at compile time
+ * (see Instruction::Decode), when the compiler can evaluate loops in
+ * constant expressions (C++14).
+ */
+
+#if __cplusplus >= 201402L
+#define DECODE_CONSTEXPR	constexpr
+#else
+#define DECODE_CONSTEXPR
+#endif
+
+static const DECODE_CONSTEXPR OpInfo opTable[] = {
     {SPECIAL, RFMT}, {BCOND, IFMT}, {OP_J, JFMT}, {OP_JAL, JFMT},
     {OP_BEQ, IFMT}, {OP_BNE, IFMT}, {OP_BLEZ, IFMT}, {OP_BGTZ, IFMT},
     {OP_ADDI, IFMT}, {OP_ADDIU, IFMT}, {OP_SLTI, IFMT}, {OP_SLTIU, IFMT},
@@ -138,7 +154,7 @@ static OpInfo opTable[] = {
  * instructions into the "opCode" field of a MemWord.
  */
 
-static int specialTable[] = {
+static const DECODE_CONSTEXPR int specialTable[] = {
     OP_SLL, OP_RES, OP_SRL, OP_SRA, OP_SLLV, OP_RES, OP_SRLV, OP_SRAV,
     OP_JR, OP_JALR, OP_RES, OP_RES, OP_SYSCALL, OP_UNIMP, OP_RES, OP_RES,
     OP_MFHI, OP_MTHI, OP_MFLO, OP_MTLO, OP_RES, OP_RES, OP_RES, OP_RES,
@@ -159,7 +175,7 @@ struct OpString {
     RegType args[3];
 };
 
-static struct OpString opStrings[] = {
+static const struct OpString opStrings[] = {
 	{"Shouldn't happen", {NONE, NONE, NONE}},
 	{"ADD r%d,r%d,r%d", {RD, RS, RT}},
 	{"ADDI r%d,r%d,%d", {RT, RS, EXTRA}},
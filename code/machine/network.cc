@@ -45,10 +45,12 @@ Network::Network(NetworkAddress addr, double reliability,
 
     // start polling for incoming packets
     interrupt->Schedule(NetworkReadPoll, (int)this, NetworkTime, NetworkRecvInt);
+    interrupt->WatchInput(sock);
 }
 
 Network::~Network()
 {
+    interrupt->UnwatchInput(sock);
     CloseSocket(sock);
     DeAssignNameToSocket(sockName);
 }
@@ -80,6 +82,7 @@ Network::CheckPktAvail()
     DEBUG('n', "Network received packet from %d, length %d...\n",
 	  				(int) inHdr.from, inHdr.length);
     stats->numPacketsRecvd++;
+    interrupt->UnwatchInput(sock);	// no room for more until it is read
 
     // tell post office that the packet has arrived
     (*readHandler)(handlerArg);	
@@ -134,5 +137,6 @@ Network::Receive(char* data)
     inHdr.length = 0;
     if (hdr.length != 0)
     	bcopy(inbox, data, hdr.length);
+    interrupt->WatchInput(sock);	// room for the next packet
     return hdr;
 }
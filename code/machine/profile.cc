@@ -0,0 +1,548 @@
+// profile.cc
+//	Routines to profile user programs: count the instructions fetched,
+//	follow the call chains, and print the results when the machine
+//	halts.  See profile.h for an overview.
+//
+//	The call tree has one node per call chain seen so far; a node is
+//	keyed by the address of the procedure it stands for (the start of
+//	the symbol holding the PC, or the call target itself if we have no
+//	symbols).  Each thread points to the node of the function it is
+//	executing, and each instruction fetched is charged to that node.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "profile.h"
+#include "machine.h"
+#include "mipssim.h"
+#include "system.h"
+
+#define MaxNameLen	64	// longest procedure name kept
+
+// One node of the call tree.
+
+class ProfileNode {
+  public:
+    int key;			// address of the procedure
+    int depth;			// number of calls from the root
+    long long self;		// instructions fetched in this chain
+    ProfileNode *parent;
+    ProfileNode *child;		// first callee
+    ProfileNode *sibling;	// next callee of the parent
+};
+
+//----------------------------------------------------------------------
+// NewNode
+// 	Allocate a call tree node for procedure "key" called by "parent".
+//----------------------------------------------------------------------
+
+static ProfileNode *
+NewNode(ProfileNode *parent, int key)
+{
+    ProfileNode *node = new ProfileNode;
+
+    node->key = key;
+    node->depth = (parent != NULL) ? parent->depth + 1 : 0;
+    node->self = 0;
+    node->parent = parent;
+    node->child = NULL;
+    node->sibling = NULL;
+    if (parent != NULL) {
+	node->sibling = parent->child;
+	parent->child = node;
+    }
+    return node;
+}
+
+//----------------------------------------------------------------------
+// Child
+// 	Return the node for procedure "key" called from "parent",
+//	creating it the first time.
+//----------------------------------------------------------------------
+
+static ProfileNode *
+Child(ProfileNode *parent, int key)
+{
+    for (ProfileNode *node = parent->child; node != NULL; node = node->sibling)
+	if (node->key == key)
+	    return node;
+    return NewNode(parent, key);
+}
+
+//----------------------------------------------------------------------
+// DeleteTree
+// 	De-allocate "node" and everything below it.
+//----------------------------------------------------------------------
+
+static void
+DeleteTree(ProfileNode *node)
+{
+    ProfileNode *next;
+
+    for (ProfileNode *child = node->child; child != NULL; child = next) {
+	next = child->sibling;
+	DeleteTree(child);
+    }
+    delete node;
+}
+
+//----------------------------------------------------------------------
+// Profiler::Profiler
+// 	Start counting.  Nothing is known about the program yet; PCs are
+//	counted one by one up to the size of physical memory, and more
+//	room is made when a program goes further.
+//
+//	"stacksFile" -- where Report writes the collapsed call chains
+//----------------------------------------------------------------------
+
+Profiler::Profiler(const char *stacksFile)
+{
+    stacksFileName = stacksFile;
+    numWords = MemorySize / 4;
+    pcCounts = new long long[numWords];
+    for (unsigned int i = 0; i < numWords; i++)
+	pcCounts[i] = 0;
+    farCount = 0;
+    for (int i = 0; i <= MaxOpcode; i++)
+	opCounts[i] = 0;
+    total = 0;
+
+    numSymbols = 0;
+    symAddr = NULL;
+    symName = NULL;
+    symbolsLoaded = FALSE;
+
+    root = NewNode(NULL, -1);
+}
+
+//----------------------------------------------------------------------
+// Profiler::~Profiler
+// 	De-allocate the counters, the symbols and the call tree.
+//----------------------------------------------------------------------
+
+Profiler::~Profiler()
+{
+    delete [] pcCounts;
+    for (int i = 0; i < numSymbols; i++)
+	delete [] symName[i];
+    delete [] symAddr;
+    delete [] symName;
+    DeleteTree(root);
+}
+
+//----------------------------------------------------------------------
+// Profiler::LoadSymbols
+// 	Read the procedures of "program" from <program>.sym, as written
+//	by coff2noff: one "address name" pair per line.  All the user
+//	programs share the same virtual addresses, so we only use the
+//	symbols of the first program loaded; the profile of the others
+//	is then only meaningful by address.
+//----------------------------------------------------------------------
+
+void
+Profiler::LoadSymbols(const char *program)
+{
+    char *fileName, name[MaxNameLen];
+    unsigned int addr;
+    FILE *file;
+    int i, j, tmpAddr;
+    char *tmpName;
+
+    if (symbolsLoaded)
+	return;
+    symbolsLoaded = TRUE;
+
+    fileName = new char[strlen(program) + 5];
+    sprintf(fileName, "%s.sym", program);
+    file = fopen(fileName, "r");
+    if (file == NULL) {
+	printf("Profiler: no symbols in %s, reporting addresses only\n",
+	       fileName);
+	delete [] fileName;
+	return;
+    }
+
+    while (fscanf(file, "%x %63s", &addr, name) == 2)
+	numSymbols++;
+    symAddr = new int[numSymbols];
+    symName = new char *[numSymbols];
+    rewind(file);
+    for (i = 0; i < numSymbols
+	     && fscanf(file, "%x %63s", &addr, name) == 2; i++) {
+	symAddr[i] = addr;
+	symName[i] = new char[strlen(name) + 1];
+	strcpy(symName[i], name);
+    }
+    numSymbols = i;
+    fclose(file);
+    DEBUG('m', "Profiler: %d symbols read from %s\n", numSymbols, fileName);
+    delete [] fileName;
+
+    // Sort by address (the files are short: an insertion sort will do).
+    for (i = 1; i < numSymbols; i++) {
+	tmpAddr = symAddr[i];
+	tmpName = symName[i];
+	for (j = i; j > 0 && symAddr[j - 1] > tmpAddr; j--) {
+	    symAddr[j] = symAddr[j - 1];
+	    symName[j] = symName[j - 1];
+	}
+	symAddr[j] = tmpAddr;
+	symName[j] = tmpName;
+    }
+}
+
+//----------------------------------------------------------------------
+// Profiler::FindSymbol
+// 	Return the index of the procedure holding "pc", that is the last
+//	symbol at or below "pc", or -1 if there is none.
+//----------------------------------------------------------------------
+
+int
+Profiler::FindSymbol(int pc)
+{
+    int low = 0, high = numSymbols - 1, mid;
+
+    if (numSymbols == 0 || pc < symAddr[0])
+	return -1;
+    while (low < high) {		// symAddr[low] <= pc always
+	mid = (low + high + 1) / 2;
+	if (symAddr[mid] <= pc)
+	    low = mid;
+	else
+	    high = mid - 1;
+    }
+    return low;
+}
+
+//----------------------------------------------------------------------
+// Profiler::FunctionOf
+// 	Return the call tree key for the procedure holding "pc": its
+//	address, or "pc" itself if it is not covered by any symbol.
+//----------------------------------------------------------------------
+
+int
+Profiler::FunctionOf(int pc)
+{
+    int sym = FindSymbol(pc);
+
+    return (sym >= 0) ? symAddr[sym] : pc;
+}
+
+//----------------------------------------------------------------------
+// Profiler::FunctionName
+// 	Return a printable name for the function with key "key", using
+//	"buf" (at least MaxNameLen + 16 bytes) if needed.
+//----------------------------------------------------------------------
+
+const char *
+Profiler::FunctionName(int key, char *buf)
+{
+    int sym = FindSymbol(key);
+
+    if (sym < 0)
+	sprintf(buf, "0x%x", key);
+    else if (symAddr[sym] == key)
+	return symName[sym];
+    else
+	sprintf(buf, "%s+0x%x", symName[sym], key - symAddr[sym]);
+    return buf;
+}
+
+//----------------------------------------------------------------------
+// Profiler::Grow
+// 	Enlarge pcCounts so that it covers PC "word" * 4.
+//----------------------------------------------------------------------
+
+void
+Profiler::Grow(unsigned int word)
+{
+    unsigned int size = numWords;
+    long long *counts;
+
+    while (size <= word)
+	size *= 2;
+    if (size > MaxProfileWords)
+	size = MaxProfileWords;
+    counts = new long long[size];
+    for (unsigned int i = 0; i < size; i++)
+	counts[i] = (i < numWords) ? pcCounts[i] : 0;
+    delete [] pcCounts;
+    pcCounts = counts;
+    numWords = size;
+}
+
+//----------------------------------------------------------------------
+// Profiler::Count
+// 	Account for the fetch of "instr" at virtual address "pc", by the
+//	current thread.  Called by Machine::FetchInstruction, for every
+//	engine.
+//
+//	Calls and returns are only noted here; the thread moves in the
+//	call tree when it reaches the target (see Arrive), so that the
+//	delay slot is charged to the right function.
+//----------------------------------------------------------------------
+
+void
+Profiler::Count(int pc, Instruction *instr)
+{
+    ProfileCursor *cursor = &currentThread->profile;
+    unsigned int word = (unsigned int) pc / 4;
+
+    total++;
+    if (word >= numWords && word < MaxProfileWords)
+	Grow(word);
+    if (word < numWords)
+	pcCounts[word]++;
+    else
+	farCount++;
+    opCounts[instr->opCode]++;
+
+    if (cursor->node == NULL)		// first instruction of the thread
+	cursor->node = Child(root, FunctionOf(pc));
+    else if (pc == cursor->target)
+	Arrive(cursor, pc);
+    cursor->node->self++;
+
+    switch (instr->opCode) {
+      case OP_JAL:
+	cursor->target = ((machine->registers[NextPCReg] + 4) & 0xf0000000)
+	    | IndexToAddr(instr->extra);
+	cursor->call = TRUE;
+	break;
+      case OP_JALR:
+	cursor->target = machine->registers[instr->rs];
+	cursor->call = TRUE;
+	break;
+      case OP_JR:
+	if (instr->rs == RetAddrReg) {
+	    cursor->target = machine->registers[instr->rs];
+	    cursor->call = FALSE;
+	}
+	break;
+    }
+}
+
+//----------------------------------------------------------------------
+// Profiler::Arrive
+// 	The current thread reached the target of the call or return it
+//	fetched last: move to the callee, or back to the caller.
+//
+//	A return goes back to the closest caller holding "pc", so that
+//	the shadow stack recovers from calls it did not see (tail calls
+//	through a plain jump, for instance).
+//----------------------------------------------------------------------
+
+void
+Profiler::Arrive(ProfileCursor *cursor, int pc)
+{
+    ProfileNode *node;
+    int key = FunctionOf(pc);
+
+    cursor->target = -1;
+    if (cursor->call) {
+	if (cursor->node->depth >= MaxProfileDepth)
+	    cursor->overflow++;
+	else
+	    cursor->node = Child(cursor->node, key);
+	return;
+    }
+
+    if (cursor->overflow > 0) {
+	cursor->overflow--;
+	return;
+    }
+    for (node = cursor->node->parent; node != root; node = node->parent)
+	if (node->key == key) {
+	    cursor->node = node;
+	    return;
+	}
+    // Returning to a caller we never saw: start a new top-level chain.
+    if (cursor->node->key != key)
+	cursor->node = Child(root, key);
+}
+
+//----------------------------------------------------------------------
+// Profiler::Report
+// 	Print the profile, and write the call chains to the stacks file.
+//	Called when the machine halts.
+//----------------------------------------------------------------------
+
+void
+Profiler::Report()
+{
+    FILE *file;
+    char *path;
+
+    printf("\nProfile: %lld instructions fetched\n", total);
+    if (total == 0)
+	return;
+    PrintFlat();
+    PrintHotPCs();
+    PrintOpcodes();
+    PrintPages();
+
+    file = fopen(stacksFileName, "w");
+    if (file == NULL) {
+	perror(stacksFileName);
+	return;
+    }
+    path = new char[(MaxProfileDepth + 1) * (MaxNameLen + 16)];
+    for (ProfileNode *node = root->child; node != NULL; node = node->sibling)
+	WriteStacks(file, node, path, 0);
+    delete [] path;
+    fclose(file);
+    printf("Call chains written to %s\n", stacksFileName);
+}
+
+//----------------------------------------------------------------------
+// Profiler::PrintFlat
+// 	Print the instructions fetched in each procedure, most first.
+//----------------------------------------------------------------------
+
+void
+Profiler::PrintFlat()
+{
+    int n = numSymbols + 1;		// the last slot is "unknown"
+    long long *counts = new long long[n];
+    int *order = new int[n];
+    int i, j, sym, tmp;
+
+    for (i = 0; i < n; i++) {
+	counts[i] = 0;
+	order[i] = i;
+    }
+    for (unsigned int w = 0; w < numWords; w++)
+	if (pcCounts[w] != 0) {
+	    sym = FindSymbol(w * 4);
+	    counts[(sym >= 0) ? sym : numSymbols] += pcCounts[w];
+	}
+    counts[numSymbols] += farCount;
+
+    for (i = 1; i < n; i++) {
+	tmp = order[i];
+	for (j = i; j > 0 && counts[order[j - 1]] < counts[tmp]; j--)
+	    order[j] = order[j - 1];
+	order[j] = tmp;
+    }
+
+    printf("\nFlat profile:\n      %%  instructions  procedure\n");
+    for (i = 0; i < n && counts[order[i]] != 0; i++)
+	printf("  %5.1f  %12lld  %s\n", 100.0 * counts[order[i]] / total,
+	       counts[order[i]],
+	       (order[i] < numSymbols) ? symName[order[i]] : "<unknown>");
+
+    delete [] counts;
+    delete [] order;
+}
+
+//----------------------------------------------------------------------
+// Profiler::PrintHotPCs
+// 	Print the ProfileHotPCs most fetched instructions.
+//----------------------------------------------------------------------
+
+void
+Profiler::PrintHotPCs()
+{
+    char buf[MaxNameLen + 16];
+    long long last = -1;	// count of the previous PC printed
+    unsigned int lastWord = 0, best;
+
+    printf("\nHot PCs:\n      %%  instructions  PC\n");
+    for (int i = 0; i < ProfileHotPCs; i++) {
+	// Find the next PC in decreasing order of counts, then address.
+	best = numWords;
+	for (unsigned int w = 0; w < numWords; w++) {
+	    if (pcCounts[w] == 0 || (last >= 0 && (pcCounts[w] > last
+			|| (pcCounts[w] == last && w <= lastWord))))
+		continue;
+	    if (best == numWords || pcCounts[w] > pcCounts[best])
+		best = w;
+	}
+	if (best == numWords)
+	    break;
+	printf("  %5.1f  %12lld  0x%08x %s\n", 100.0 * pcCounts[best] / total,
+	       pcCounts[best], best * 4, FunctionName(best * 4, buf));
+	last = pcCounts[best];
+	lastWord = best;
+    }
+}
+
+//----------------------------------------------------------------------
+// Profiler::PrintOpcodes
+// 	Print the instructions fetched for each opcode, most first.
+//----------------------------------------------------------------------
+
+void
+Profiler::PrintOpcodes()
+{
+    int order[MaxOpcode + 1];
+    int i, j, tmp;
+    const char *name;
+
+    for (i = 0; i <= MaxOpcode; i++)
+	order[i] = i;
+    for (i = 1; i <= MaxOpcode; i++) {
+	tmp = order[i];
+	for (j = i; j > 0 && opCounts[order[j - 1]] < opCounts[tmp]; j--)
+	    order[j] = order[j - 1];
+	order[j] = tmp;
+    }
+
+    printf("\nOpcodes:\n      %%  instructions  opcode\n");
+    for (i = 0; i <= MaxOpcode && opCounts[order[i]] != 0; i++) {
+	name = opStrings[order[i]].string;
+	printf("  %5.1f  %12lld  %.*s\n", 100.0 * opCounts[order[i]] / total,
+	       opCounts[order[i]], (int) strcspn(name, " "), name);
+    }
+}
+
+//----------------------------------------------------------------------
+// Profiler::PrintPages
+// 	Print the instructions fetched from each virtual page.
+//----------------------------------------------------------------------
+
+void
+Profiler::PrintPages()
+{
+    unsigned int wordsPerPage = PageSize / 4;
+    long long count;
+
+    printf("\nFetches by virtual page:\n      %%  instructions  page\n");
+    for (unsigned int page = 0; page * wordsPerPage < numWords; page++) {
+	count = 0;
+	for (unsigned int w = page * wordsPerPage;
+	     w < (page + 1) * wordsPerPage && w < numWords; w++)
+	    count += pcCounts[w];
+	if (count != 0)
+	    printf("  %5.1f  %12lld  %d\n", 100.0 * count / total, count, page);
+    }
+    if (farCount != 0)
+	printf("  %5.1f  %12lld  above 0x%x\n", 100.0 * farCount / total,
+	       farCount, MaxProfileWords * 4);
+}
+
+//----------------------------------------------------------------------
+// Profiler::WriteStacks
+// 	Write the call chain of "node" and of everything below it, in
+//	collapsed stack format.  "path" holds the names of the callers
+//	of "node", separated by ';', over "len" characters.
+//----------------------------------------------------------------------
+
+void
+Profiler::WriteStacks(FILE *file, ProfileNode *node, char *path, int len)
+{
+    char buf[MaxNameLen + 16];
+
+    if (len > 0)
+	path[len++] = ';';
+    strcpy(path + len, FunctionName(node->key, buf));
+    len += strlen(path + len);
+
+    if (node->self != 0)
+	fprintf(file, "%s %lld\n", path, node->self);
+    for (ProfileNode *child = node->child; child != NULL;
+	 child = child->sibling)
+	WriteStacks(file, child, path, len);
+}
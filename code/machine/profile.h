@@ -0,0 +1,97 @@
+// profile.h
+//	Data structures for profiling user programs.
+//
+//	When Nachos is started with "-prof <file>", every user instruction
+//	fetched is counted, by virtual PC and by opcode.  The profiler also
+//	follows calls (JAL, JALR) and returns (JR r31) to keep a shadow call
+//	stack for each thread, and counts instructions by call chain.
+//
+//	When the machine halts, the counts are matched against the
+//	procedures listed in the program's symbol file (written by
+//	coff2noff next to the Nachos executable, as <program>.sym), and
+//	we print a flat profile, the hottest PCs, the opcode mix and the
+//	fetches per page.  The call chains are written to <file> in the
+//	"collapsed stack" format read by flame graph tools:
+//
+//		main;Compute;Mult 1234
+//
+//	The counts are exact, not sampled: the simulator pays a function
+//	call per instruction, and only when profiling is on.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "copyright.h"
+#include "utility.h"
+
+#define MaxProfileDepth	256	// deeper calls are charged to the
+				// deepest function recorded
+#define MaxProfileWords	(1 << 20)	// PCs counted one by one, in words;
+				// above, they are only counted in total
+#define ProfileHotPCs	20	// number of hot PCs printed
+
+class Instruction;
+class ProfileNode;
+
+// Where a thread stands in the call tree.  Each thread has one (see
+// thread.h); a call or a return is noted when it is fetched, and takes
+// effect when the thread reaches its target, after the delay slot.
+
+struct ProfileCursor {
+    ProfileNode *node;		// function being executed, NULL until
+				// the thread runs its first instruction
+    int target;			// PC where a pending call or return
+				// takes effect, -1 if none
+    bool call;			// TRUE for a call, FALSE for a return
+    int overflow;		// calls not recorded, past MaxProfileDepth
+};
+
+// The following class defines the profiler.
+
+class Profiler {
+  public:
+    Profiler(const char *stacksFile);	// Start profiling; write the call
+				// chains to "stacksFile" at the end
+    ~Profiler();
+
+    void LoadSymbols(const char *program);
+				// Read <program>.sym, if not done yet
+    void Count(int pc, Instruction *instr);
+				// Account for fetching "instr" at "pc"
+    void Report();		// Print the profile, write the stacks
+
+  private:
+    const char *stacksFileName;
+
+    long long *pcCounts;	// fetches, by PC / 4
+    unsigned int numWords;	// size of pcCounts
+    long long farCount;		// fetches above MaxProfileWords * 4
+    long long opCounts[64];	// fetches, by opcode (see mipssim.h)
+    long long total;		// fetches in all
+
+    int numSymbols;		// procedures, sorted by address
+    int *symAddr;
+    char **symName;
+    bool symbolsLoaded;
+
+    ProfileNode *root;		// call tree, one node per call chain
+
+    int FindSymbol(int pc);	// procedure holding "pc", or -1
+    int FunctionOf(int pc);	// key of the function holding "pc"
+    const char *FunctionName(int key, char *buf);
+				// printable name of a function key
+    void Grow(unsigned int word);	// make room to count PC "word" * 4
+    void Arrive(ProfileCursor *cursor, int pc);
+				// a pending call or return takes effect
+    void PrintFlat();
+    void PrintHotPCs();
+    void PrintOpcodes();
+    void PrintPages();
+    void WriteStacks(FILE *file, ProfileNode *node, char *path, int len);
+};
+
+#endif // PROFILE_H
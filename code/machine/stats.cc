@@ -22,6 +22,37 @@ Statistics::Statistics()
     numDiskReads = numDiskWrites = 0;
     numConsoleCharsRead = numConsoleCharsWritten = 0;
     numPageFaults = numPacketsSent = numPacketsRecvd = 0;
+    numMajorFaults = numMinorFaults = 0;
+    numEvictions = numDirtyWritebacks = 0;
+    numContextSwitches = numThreadsFinished = 0;
+    threadTicks = maxThreadTicks = 0;
+    numRtJobs = numDeadlineMisses = numBudgetOverruns = 0;
+    numRtThreads = 0;
+}
+
+//----------------------------------------------------------------------
+// Statistics::NewRtThread
+// 	Allocate the counters of a thread entering the real-time class,
+//	with "period" and "budget".  Return their index in rtThreads,
+//	-1 if all are taken: the thread is then only counted in the
+//	totals.
+//----------------------------------------------------------------------
+
+int
+Statistics::NewRtThread(const char *name, int period, int budget)
+{
+    RtThreadStats *s;
+
+    if (numRtThreads == MaxRtThreads)
+	return -1;
+    s = &rtThreads[numRtThreads];
+    strncpy(s->name, name, sizeof(s->name) - 1);
+    s->name[sizeof(s->name) - 1] = '\0';
+    s->period = period;
+    s->budget = budget;
+    s->jobs = s->misses = s->overruns = 0;
+    s->maxLateness = 0;
+    return numRtThreads++;
 }
 
 //----------------------------------------------------------------------
@@ -43,7 +74,25 @@ Statistics::Print()
     printf("Disk I/O: reads %d, writes %d\n", numDiskReads, numDiskWrites);
     printf("Console I/O: reads %d, writes %d\n", numConsoleCharsRead, 
 	numConsoleCharsWritten);
-    printf("Paging: faults %d\n", numPageFaults);
+    printf("Paging: faults %d (major %d, minor %d), evictions %d, "
+	"dirty writebacks %d\n", numPageFaults, numMajorFaults,
+	numMinorFaults, numEvictions, numDirtyWritebacks);
     printf("Network I/O: packets received %d, sent %d\n", numPacketsRecvd, 
 	numPacketsSent);
+    printf("Threads: context switches %d, finished %d", numContextSwitches,
+	numThreadsFinished);
+    if (numThreadsFinished > 0)
+	printf(", ticks per thread avg %lld, max %lld",
+	    threadTicks / numThreadsFinished, maxThreadTicks);
+    printf("\n");
+    if (numRtJobs > 0)
+	printf("Real-time: jobs %d, deadline misses %d, budget overruns %d\n",
+	    numRtJobs, numDeadlineMisses, numBudgetOverruns);
+    for (int i = 0; i < numRtThreads; i++) {
+	RtThreadStats *s = &rtThreads[i];
+
+	printf("  %s (period %d, budget %d): jobs %d, misses %d, "
+	    "overruns %d, max lateness %lld\n", s->name, s->period,
+	    s->budget, s->jobs, s->misses, s->overruns, s->maxLateness);
+    }
 }
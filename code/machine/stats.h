@@ -13,6 +13,22 @@
 
 #include "copyright.h"
 
+#define MaxRtThreads	16	// real-time threads with counters of their own
+
+// Counters of one real-time thread (see Scheduler::SetRealTime).
+
+class RtThreadStats {
+  public:
+    char name[16];		// name of the thread
+    int period;			// its period and budget, in ticks
+    int budget;
+    int jobs;			// jobs released
+    int misses;			// jobs that missed their deadline
+    int overruns;		// jobs that used up their budget
+    long long maxLateness;	// worst time a job finished after its
+				// deadline
+};
+
 // The following class defines the statistics that are to be kept
 // about Nachos behavior -- how much time (ticks) elapsed, how
 // many user instructions executed, etc.
@@ -43,12 +59,28 @@ class Statistics {
     int numConsoleCharsRead;	// number of characters read from the keyboard
     int numConsoleCharsWritten; // number of characters written to the display
     int numPageFaults;		// number of virtual memory page faults
+    int numMajorFaults;		// of which read the page in
+    int numMinorFaults;		// of which did not
+    int numEvictions;		// pages taken out of main memory
+    int numDirtyWritebacks;	// of which written to the swap space
     int numPacketsSent;		// number of packets sent over the network
     int numPacketsRecvd;	// number of packets received over the network
+    int numContextSwitches;	// number of times a thread was switched to
+    int numThreadsFinished;	// number of threads that finished
+    long long threadTicks;	// total time the finished threads ran
+    long long maxThreadTicks;	// longest time a finished thread ran
+    int numRtJobs;		// jobs of real-time threads released
+    int numDeadlineMisses;	// of which missed their deadline
+    int numBudgetOverruns;	// of which used up their budget
+    int numRtThreads;		// real-time threads with counters
+    RtThreadStats rtThreads[MaxRtThreads];
 
     Statistics(); 		// initialize everything to zero
 
     void Print();		// print collected statistics
+    int NewRtThread(const char *name, int period, int budget);
+				// counters for a new real-time thread,
+				// -1 if there is no room left
 };
 
 // Constants used to reflect the relative time an operation would
@@ -37,12 +37,14 @@ SynchConsole::~SynchConsole(){
 void SynchConsole::SynchPutChar(const char ch){
   writeMutex->P();
   console->PutChar(ch);
+  scheduler->IoWait(currentThread);
   writeDone->P();
   writeMutex->V();
 }
 
 char SynchConsole::SynchGetChar(){
   readMutex->P();
+  scheduler->IoWait(currentThread);
   readAvail->P ();	// wait for character to arrive
   return console->GetChar ();
   readMutex->V();
@@ -67,6 +69,7 @@ void SynchConsole::SynchGetString(char *s, int n){
     char cr;
     int i;
     for(i=0;i<n;i++){
+      scheduler->IoWait(currentThread);
       readAvail->P ();	// wait for character to arrive
       cr = console->GetChar ();
       if (cr == EOF){
@@ -100,13 +100,10 @@ int sendto (int, const void*, int, int, void*, int);
 //	characters that can be read immediately.  If so, read them
 //	in, and return TRUE.
 //
-//	In the network case, if there are no threads for us to run,
-//	and no characters to be read,
-//	we need to give the other side a chance to get our host's CPU
-//	(otherwise, we'll go really slowly, since UNIX time-slices
-//	infrequently, and this would be like busy-waiting).  So we
-//	delay for a short fixed time, before allowing ourselves to be
-//	re-scheduled (sort of like a Yield, but cast in terms of UNIX).
+//	Never waits: when there are no threads for us to run, and
+//	nothing to do but poll, Interrupt::Idle blocks in WaitForInput
+//	instead, which also gives the other side of the network (or the
+//	user at the keyboard) a chance to get our host's CPU.
 //
 //	"fd" -- the file descriptor of the file to be polled
 //----------------------------------------------------------------------
@@ -117,12 +114,8 @@ PollFile(int fd)
     int rfd = (1 << fd), wfd = 0, xfd = 0, retVal;
     struct timeval pollTime;
 
-// decide how long to wait if there are no characters on the file
     pollTime.tv_sec = 0;
-    if (interrupt->getStatus() == IdleMode)
-        pollTime.tv_usec = 20000;              	// delay to let other nachos run
-    else
-        pollTime.tv_usec = 0;                 	// no delay
+    pollTime.tv_usec = 0;                 	// no delay
 
 // poll file or socket
 #if defined(HOST_i386) || defined(SOLARIS)
@@ -235,6 +228,21 @@ Tell(int fd)
 #endif
 }
 
+//----------------------------------------------------------------------
+// FileNumber
+// 	Return the inode number of an open file: two files open at the
+//	same time have the same one only if they are the same file.
+//----------------------------------------------------------------------
+
+int 
+FileNumber(int fd)
+{
+    struct stat buf;
+    int retVal = fstat(fd, &buf);
+    ASSERT(retVal >= 0);
+    return (int) buf.st_ino;
+}
+
 
 //----------------------------------------------------------------------
 // Close
@@ -330,6 +338,38 @@ DeAssignNameToSocket(const char *socketName)
     (void) unlink(socketName);
 }
 
+//----------------------------------------------------------------------
+// WaitForInput
+// 	Block until one of the open files or sockets "fds" has
+//	characters that can be read, or until "timeout" microseconds
+//	have passed.  Used when Nachos is idle, so that the host does not
+//	spin polling the files.
+//
+//	"fds" -- the file descriptors of the files to wait on
+//	"numFds" -- how many there are (may be 0, to just sleep)
+//	"timeout" -- longest wait, in microseconds; negative for no limit
+//----------------------------------------------------------------------
+
+void
+WaitForInput(int *fds, int numFds, int timeout)
+{
+    fd_set readFds;
+    struct timeval waitTime;
+    int maxFd = -1, retVal;
+
+    FD_ZERO(&readFds);
+    for (int i = 0; i < numFds; i++) {
+	FD_SET(fds[i], &readFds);
+	if (fds[i] > maxFd)
+	    maxFd = fds[i];
+    }
+    waitTime.tv_sec = timeout / 1000000;
+    waitTime.tv_usec = timeout % 1000000;
+    retVal = select(maxFd + 1, &readFds, NULL, NULL,
+		    (timeout < 0) ? NULL : &waitTime);
+    ASSERT(retVal >= 0 || errno == EINTR);
+}
+
 //----------------------------------------------------------------------
 // PollSocket
 // 	Return TRUE if there are any messages waiting to arrive on the
@@ -417,6 +457,21 @@ Delay(int seconds)
     (void) sleep((unsigned) seconds);
 }
 
+//----------------------------------------------------------------------
+// HostMicroseconds
+// 	Return the wall-clock time of the host, in microseconds.  Only
+//	used to time benchmarks: simulated time is in stats->totalTicks.
+//----------------------------------------------------------------------
+
+long long
+HostMicroseconds()
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (long long) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
 //----------------------------------------------------------------------
 // Abort
 // 	Quit and drop core.
@@ -17,6 +17,10 @@
 // If no characters in the file, return without waiting.
 extern bool PollFile(int fd);
 
+// Wait until one of the files has characters to be read, or "timeout"
+// microseconds have passed (no limit if "timeout" is negative).
+extern void WaitForInput(int *fds, int numFds, int timeout);
+
 // File operations: open/read/write/lseek/close, and check for error
 // For simulating the disk and the console devices.
 extern int OpenForWrite(const char *name);
@@ -26,6 +30,7 @@ extern int ReadPartial(int fd, char *buffer, int nBytes);
 extern void WriteFile(int fd, const char *buffer, int nBytes);
 extern void Lseek(int fd, int offset, int whence);
 extern int Tell(int fd);
+extern int FileNumber(int fd);
 extern void Close(int fd);
 extern bool Unlink(const char *name);
 
@@ -43,6 +48,9 @@ extern void Abort();
 extern void Exit(int exitCode);
 extern void Delay(int seconds);
 
+// Host wall-clock time, in microseconds, for measurements only
+extern long long HostMicroseconds();
+
 // Initialize system so that cleanUp routine is called when user hits ctl-C
 extern void CallOnUserAbort(VoidNoArgFunctionPtr cleanUp);
 
@@ -0,0 +1,558 @@
+// threadedsim.cc -- threaded-dispatch execution engine for the MIPS
+//	simulator.
+//
+//   The reference interpreter (Machine::ExecuteInstruction in
+//   mipssim.cc) goes through a single "switch" for every instruction,
+//   so the host branch predictor has one indirect jump to predict for
+//   the whole instruction stream.  Here each opcode has its own
+//   handler, and each handler ends by jumping directly to the handler
+//   of the next instruction (GNU "labels as values").  Every handler
+//   thus has its own indirect jump, which predicts much better on
+//   the short loops typical of user programs.
+//
+//   The semantics must stay exactly those of mipssim.cc, including
+//   the load delay slot (DelayedLoad, LoadReg/LoadValueReg) and the
+//   branch delay slot (NextPCReg).  Run with "-engine lockstep" to
+//   check both engines against each other, instruction by instruction.
+//
+//   Compilers without computed gotos fall back on the switch.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+
+#include "machine.h"
+#include "mipssim.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// Machine::NextThreaded
+// 	Account for the instruction just executed (or trapped), then
+//	fetch the next one, as the loop in Machine::Run does.  Retry as
+//	long as the fetch itself traps.
+//----------------------------------------------------------------------
+
+Instruction *
+Machine::NextThreaded()
+{
+    Instruction *instr;
+
+    do {
+	Tick();
+	if (singleStep && (runUntilTime <= stats->totalTicks))
+	    Debugger();
+	instr = FetchInstruction();
+    } while (instr == NULL);
+    return instr;
+}
+
+#ifdef __GNUC__
+
+// Finish the current instruction: apply the delayed load and advance
+// the program counters, exactly as at the end of ExecuteInstruction.
+#define COMPLETE() \
+    do { \
+	DelayedLoad(nextLoadReg, nextLoadValue); \
+	registers[PrevPCReg] = registers[PCReg]; \
+	registers[PCReg] = registers[NextPCReg]; \
+	registers[NextPCReg] = pcAfter; \
+    } while (0)
+
+// Go on with the next instruction, or return if we were asked to run
+// only one.  Used directly (without COMPLETE) after an exception.
+#define DISPATCH() \
+    do { \
+	if (!chain) \
+	    return; \
+	instr = NextThreaded(); \
+	goto start; \
+    } while (0)
+
+#define NEXT()	do { COMPLETE(); DISPATCH(); } while (0)
+
+//----------------------------------------------------------------------
+// Machine::ExecuteThreaded
+// 	Execute decoded user instructions, starting with "instr".
+//
+//	"chain" -- if FALSE, return after "instr" (used for lockstep
+//	checking); if TRUE, keep executing instructions forever, like
+//	Machine::Run.
+//
+//	As in ExecuteInstruction, an instruction that raises an
+//	exception leaves the program counters alone: the kernel decides
+//	where to resume.
+//----------------------------------------------------------------------
+
+void
+Machine::ExecuteThreaded(Instruction *instr, bool chain)
+{
+    static const void *dispatch[MaxOpcode + 1] = {
+	&&op_bad, &&op_add, &&op_addi, &&op_addiu,		// 0-3
+	&&op_addu, &&op_and, &&op_andi, &&op_beq,		// 4-7
+	&&op_bgez, &&op_bgezal, &&op_bgtz, &&op_blez,		// 8-11
+	&&op_bltz, &&op_bltzal, &&op_bne, &&op_bad,		// 12-15
+	&&op_div, &&op_divu, &&op_j, &&op_jal,			// 16-19
+	&&op_jalr, &&op_jr, &&op_lb, &&op_lb,			// 20-23
+	&&op_lh, &&op_lh, &&op_lui, &&op_lw,			// 24-27
+	&&op_lwl, &&op_lwr, &&op_bad, &&op_mfhi,		// 28-31
+	&&op_mflo, &&op_bad, &&op_mthi, &&op_mtlo,		// 32-35
+	&&op_mult, &&op_multu, &&op_nor, &&op_or,		// 36-39
+	&&op_ori, &&op_bad, &&op_sb, &&op_sh,			// 40-43
+	&&op_sll, &&op_sllv, &&op_slt, &&op_slti,		// 44-47
+	&&op_sltiu, &&op_sltu, &&op_sra, &&op_srav,		// 48-51
+	&&op_srl, &&op_srlv, &&op_sub, &&op_subu,		// 52-55
+	&&op_sw, &&op_swl, &&op_swr, &&op_xor,			// 56-59
+	&&op_xori, &&op_syscall, &&op_illegal, &&op_illegal	// 60-63
+    };
+    bool tracing = DebugIsEnabled('m');
+    int nextLoadReg, nextLoadValue;
+    int pcAfter, sum, diff, tmp, value;
+    unsigned int rs, rt, imm, tmp_unsigned;
+
+    if (instr == NULL)			// the first fetch trapped
+	DISPATCH();
+
+  start:
+    if (tracing)
+	TraceInstruction(instr);
+    nextLoadReg = 0;
+    nextLoadValue = 0;
+    pcAfter = registers[NextPCReg] + 4;
+    goto *dispatch[instr->opCode];
+
+  op_add:
+    sum = registers[instr->rs] + registers[instr->rt];
+    if (!((registers[instr->rs] ^ registers[instr->rt]) & SIGN_BIT) &&
+	((registers[instr->rs] ^ sum) & SIGN_BIT)) {
+	RaiseException(OverflowException, 0);
+	DISPATCH();
+    }
+    registers[instr->rd] = sum;
+    NEXT();
+
+  op_addi:
+    sum = registers[instr->rs] + instr->extra;
+    if (!((registers[instr->rs] ^ instr->extra) & SIGN_BIT) &&
+	((instr->extra ^ sum) & SIGN_BIT)) {
+	RaiseException(OverflowException, 0);
+	DISPATCH();
+    }
+    registers[instr->rt] = sum;
+    NEXT();
+
+  op_addiu:
+    registers[instr->rt] = registers[instr->rs] + instr->extra;
+    NEXT();
+
+  op_addu:
+    registers[instr->rd] = registers[instr->rs] + registers[instr->rt];
+    NEXT();
+
+  op_and:
+    registers[instr->rd] = registers[instr->rs] & registers[instr->rt];
+    NEXT();
+
+  op_andi:
+    registers[instr->rt] = registers[instr->rs] & (instr->extra & 0xffff);
+    NEXT();
+
+  op_beq:
+    if (registers[instr->rs] == registers[instr->rt])
+	pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
+    NEXT();
+
+  op_bgezal:
+    registers[R31] = registers[NextPCReg] + 4;
+  op_bgez:
+    if (!(registers[instr->rs] & SIGN_BIT))
+	pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
+    NEXT();
+
+  op_bgtz:
+    if (registers[instr->rs] > 0)
+	pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
+    NEXT();
+
+  op_blez:
+    if (registers[instr->rs] <= 0)
+	pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
+    NEXT();
+
+  op_bltzal:
+    registers[R31] = registers[NextPCReg] + 4;
+  op_bltz:
+    if (registers[instr->rs] & SIGN_BIT)
+	pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
+    NEXT();
+
+  op_bne:
+    if (registers[instr->rs] != registers[instr->rt])
+	pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
+    NEXT();
+
+  op_div:
+    if (registers[instr->rt] == 0) {
+	registers[LoReg] = 0;
+	registers[HiReg] = 0;
+    } else if (registers[instr->rt] == -1) {	// see ExecuteInstruction
+	registers[LoReg] = (int) (0 - (unsigned int) registers[instr->rs]);
+	registers[HiReg] = 0;
+    } else {
+	registers[LoReg] = registers[instr->rs] / registers[instr->rt];
+	registers[HiReg] = registers[instr->rs] % registers[instr->rt];
+    }
+    NEXT();
+
+  op_divu:
+    rs = (unsigned int) registers[instr->rs];
+    rt = (unsigned int) registers[instr->rt];
+    if (rt == 0) {
+	registers[LoReg] = 0;
+	registers[HiReg] = 0;
+    } else {
+	tmp = rs / rt;
+	registers[LoReg] = (int) tmp;
+	tmp = rs % rt;
+	registers[HiReg] = (int) tmp;
+    }
+    NEXT();
+
+  op_jal:
+    registers[R31] = registers[NextPCReg] + 4;
+  op_j:
+    pcAfter = (pcAfter & 0xf0000000) | IndexToAddr(instr->extra);
+    NEXT();
+
+  op_jalr:
+    registers[instr->rd] = registers[NextPCReg] + 4;
+  op_jr:
+    pcAfter = registers[instr->rs];
+    NEXT();
+
+  op_lb:				// LB and LBU
+    tmp = registers[instr->rs] + instr->extra;
+    if (!ReadMem(tmp, 1, &value))
+	DISPATCH();
+    if ((value & 0x80) && (instr->opCode == OP_LB))
+	value |= 0xffffff00;
+    else
+	value &= 0xff;
+    nextLoadReg = instr->rt;
+    nextLoadValue = value;
+    NEXT();
+
+  op_lh:				// LH and LHU
+    tmp = registers[instr->rs] + instr->extra;
+    if (tmp & 0x1) {
+	RaiseException(AddressErrorException, tmp);
+	DISPATCH();
+    }
+    if (!ReadMem(tmp, 2, &value))
+	DISPATCH();
+    if ((value & 0x8000) && (instr->opCode == OP_LH))
+	value |= 0xffff0000;
+    else
+	value &= 0xffff;
+    nextLoadReg = instr->rt;
+    nextLoadValue = value;
+    NEXT();
+
+  op_lui:
+    DEBUG('m', "Executing: LUI r%d,%d\n", instr->rt, instr->extra);
+    registers[instr->rt] = instr->extra << 16;
+    NEXT();
+
+  op_lw:
+    tmp = registers[instr->rs] + instr->extra;
+    if (tmp & 0x3) {
+	RaiseException(AddressErrorException, tmp);
+	DISPATCH();
+    }
+    if (!ReadMem(tmp, 4, &value))
+	DISPATCH();
+    nextLoadReg = instr->rt;
+    nextLoadValue = value;
+    NEXT();
+
+  op_lwl:
+    tmp = registers[instr->rs] + instr->extra;
+    ASSERT((tmp & 0x3) == 0);		// see mipssim.cc
+    if (!ReadMem(tmp, 4, &value))
+	DISPATCH();
+    if (registers[LoadReg] == instr->rt)
+	nextLoadValue = registers[LoadValueReg];
+    else
+	nextLoadValue = registers[instr->rt];
+    switch (tmp & 0x3) {
+      case 0:
+	nextLoadValue = value;
+	break;
+      case 1:
+	nextLoadValue = (nextLoadValue & 0xff) | (value << 8);
+	break;
+      case 2:
+	nextLoadValue = (nextLoadValue & 0xffff) | (value << 16);
+	break;
+      case 3:
+	nextLoadValue = (nextLoadValue & 0xffffff) | (value << 24);
+	break;
+    }
+    nextLoadReg = instr->rt;
+    NEXT();
+
+  op_lwr:
+    tmp = registers[instr->rs] + instr->extra;
+    ASSERT((tmp & 0x3) == 0);		// see mipssim.cc
+    if (!ReadMem(tmp, 4, &value))
+	DISPATCH();
+    if (registers[LoadReg] == instr->rt)
+	nextLoadValue = registers[LoadValueReg];
+    else
+	nextLoadValue = registers[instr->rt];
+    switch (tmp & 0x3) {
+      case 0:
+	nextLoadValue = (nextLoadValue & 0xffffff00) |
+	    ((value >> 24) & 0xff);
+	break;
+      case 1:
+	nextLoadValue = (nextLoadValue & 0xffff0000) |
+	    ((value >> 16) & 0xffff);
+	break;
+      case 2:
+	nextLoadValue = (nextLoadValue & 0xff000000)
+	    | ((value >> 8) & 0xffffff);
+	break;
+      case 3:
+	nextLoadValue = value;
+	break;
+    }
+    nextLoadReg = instr->rt;
+    NEXT();
+
+  op_mfhi:
+    registers[instr->rd] = registers[HiReg];
+    NEXT();
+
+  op_mflo:
+    registers[instr->rd] = registers[LoReg];
+    NEXT();
+
+  op_mthi:
+    registers[HiReg] = registers[instr->rs];
+    NEXT();
+
+  op_mtlo:
+    registers[LoReg] = registers[instr->rs];
+    NEXT();
+
+  op_mult:
+    Mult(registers[instr->rs], registers[instr->rt], TRUE,
+	 &registers[HiReg], &registers[LoReg]);
+    NEXT();
+
+  op_multu:
+    Mult(registers[instr->rs], registers[instr->rt], FALSE,
+	 &registers[HiReg], &registers[LoReg]);
+    NEXT();
+
+  op_nor:
+    registers[instr->rd] = ~(registers[instr->rs] | registers[instr->rt]);
+    NEXT();
+
+  op_or:
+    registers[instr->rd] = registers[instr->rs] | registers[instr->rt];
+    NEXT();
+
+  op_ori:
+    registers[instr->rt] = registers[instr->rs] | (instr->extra & 0xffff);
+    NEXT();
+
+  op_sb:
+    if (!WriteMem((unsigned)
+		  (registers[instr->rs] + instr->extra), 1, registers[instr->rt]))
+	DISPATCH();
+    NEXT();
+
+  op_sh:
+    if (!WriteMem((unsigned)
+		  (registers[instr->rs] + instr->extra), 2, registers[instr->rt]))
+	DISPATCH();
+    NEXT();
+
+  op_sll:
+    registers[instr->rd] = registers[instr->rt] << instr->extra;
+    NEXT();
+
+  op_sllv:
+    registers[instr->rd] = registers[instr->rt] <<
+	(registers[instr->rs] & 0x1f);
+    NEXT();
+
+  op_slt:
+    if (registers[instr->rs] < registers[instr->rt])
+	registers[instr->rd] = 1;
+    else
+	registers[instr->rd] = 0;
+    NEXT();
+
+  op_slti:
+    if (registers[instr->rs] < instr->extra)
+	registers[instr->rt] = 1;
+    else
+	registers[instr->rt] = 0;
+    NEXT();
+
+  op_sltiu:
+    rs = registers[instr->rs];
+    imm = instr->extra;
+    if (rs < imm)
+	registers[instr->rt] = 1;
+    else
+	registers[instr->rt] = 0;
+    NEXT();
+
+  op_sltu:
+    rs = registers[instr->rs];
+    rt = registers[instr->rt];
+    if (rs < rt)
+	registers[instr->rd] = 1;
+    else
+	registers[instr->rd] = 0;
+    NEXT();
+
+  op_sra:
+    registers[instr->rd] = registers[instr->rt] >> instr->extra;
+    NEXT();
+
+  op_srav:
+    registers[instr->rd] = registers[instr->rt] >>
+	(registers[instr->rs] & 0x1f);
+    NEXT();
+
+  op_srl:				// logical shift: see mipssim.cc
+    tmp_unsigned = registers[instr->rt];
+    tmp_unsigned >>= instr->extra;
+    registers[instr->rd] = tmp_unsigned;
+    NEXT();
+
+  op_srlv:
+    tmp_unsigned = registers[instr->rt];
+    tmp_unsigned >>= (registers[instr->rs] & 0x1f);
+    registers[instr->rd] = tmp_unsigned;
+    NEXT();
+
+  op_sub:
+    diff = registers[instr->rs] - registers[instr->rt];
+    if (((registers[instr->rs] ^ registers[instr->rt]) & SIGN_BIT) &&
+	((registers[instr->rs] ^ diff) & SIGN_BIT)) {
+	RaiseException(OverflowException, 0);
+	DISPATCH();
+    }
+    registers[instr->rd] = diff;
+    NEXT();
+
+  op_subu:
+    registers[instr->rd] = registers[instr->rs] - registers[instr->rt];
+    NEXT();
+
+  op_sw:
+    if (!WriteMem((unsigned)
+		  (registers[instr->rs] + instr->extra), 4, registers[instr->rt]))
+	DISPATCH();
+    NEXT();
+
+  op_swl:
+    tmp = registers[instr->rs] + instr->extra;
+    ASSERT((tmp & 0x3) == 0);		// see mipssim.cc
+    if (!ReadMem((tmp & ~0x3), 4, &value))
+	DISPATCH();
+    switch (tmp & 0x3) {
+      case 0:
+	value = registers[instr->rt];
+	break;
+      case 1:
+	value = (value & 0xff000000) | ((registers[instr->rt] >> 8) &
+					0xffffff);
+	break;
+      case 2:
+	value = (value & 0xffff0000) | ((registers[instr->rt] >> 16) &
+					0xffff);
+	break;
+      case 3:
+	value = (value & 0xffffff00) | ((registers[instr->rt] >> 24) &
+					0xff);
+	break;
+    }
+    if (!WriteMem((tmp & ~0x3), 4, value))
+	DISPATCH();
+    NEXT();
+
+  op_swr:
+    tmp = registers[instr->rs] + instr->extra;
+    ASSERT((tmp & 0x3) == 0);		// see mipssim.cc
+    if (!ReadMem((tmp & ~0x3), 4, &value))
+	DISPATCH();
+    switch (tmp & 0x3) {
+      case 0:
+	value = (value & 0xffffff) | (registers[instr->rt] << 24);
+	break;
+      case 1:
+	value = (value & 0xffff) | (registers[instr->rt] << 16);
+	break;
+      case 2:
+	value = (value & 0xff) | (registers[instr->rt] << 8);
+	break;
+      case 3:
+	value = registers[instr->rt];
+	break;
+    }
+    if (!WriteMem((tmp & ~0x3), 4, value))
+	DISPATCH();
+    NEXT();
+
+  op_syscall:
+    RaiseException(SyscallException, 0);
+    DISPATCH();
+
+  op_xor:
+    registers[instr->rd] = registers[instr->rs] ^ registers[instr->rt];
+    NEXT();
+
+  op_xori:
+    registers[instr->rt] = registers[instr->rs] ^ (instr->extra & 0xffff);
+    NEXT();
+
+  op_illegal:				// OP_RES and OP_UNIMP
+    RaiseException(IllegalInstrException, 0);
+    DISPATCH();
+
+  op_bad:				// never produced by Decode
+    ASSERT(FALSE);
+    DISPATCH();
+}
+
+#else // __GNUC__
+
+//----------------------------------------------------------------------
+// Machine::ExecuteThreaded
+// 	Without computed gotos, the threaded engine is just the switch.
+//----------------------------------------------------------------------
+
+void
+Machine::ExecuteThreaded(Instruction *instr, bool chain)
+{
+    if (!chain) {
+	ExecuteInstruction(instr);
+	return;
+    }
+    if (instr == NULL)
+	instr = NextThreaded();
+    for (;;) {
+	ExecuteInstruction(instr);
+	instr = NextThreaded();
+    }
+}
+
+#endif // __GNUC__
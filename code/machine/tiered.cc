@@ -0,0 +1,401 @@
+// tiered.cc -- tiered execution of user programs.
+//
+//   With "-engine tiered", user code starts out interpreted by the
+//   reference switch (Machine::ExecuteInstruction).  The decode cache
+//   counts how many times each block is entered; once a block is hot,
+//   its instructions are bound to "micro-ops": small functions, each
+//   specialized for one opcode (and for a few common operand patterns,
+//   like the "nop" filling most delay slots), called back to back
+//   without fetching, translating the PC or going through the switch.
+//
+//   Emitting host machine code would go further, but is not portable
+//   across the hosts Nachos runs on; micro-ops keep the same structure
+//   and leave the door open.
+//
+//   The micro-ops keep the exact semantics of the interpreter:
+//	- each one applies the delayed load and advances PCReg, NextPCReg
+//	  and PrevPCReg, so load and branch delay slots behave as usual;
+//	- an instruction that traps stops the block before touching the
+//	  program counters, so exceptions stay precise;
+//	- a store into the block's own frame (self-modifying code) drops
+//	  the micro-ops, and we go back to the interpreter at once;
+//	- a block only runs as micro-ops when no interrupt can become due
+//	  before its end (see Machine::Tick), so simulated time is the same.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+
+#include "machine.h"
+#include "mipssim.h"
+#include "decodecache.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// Advance
+// 	End of every micro-op that did not trap: apply the delayed load,
+//	then move the program counters forward.
+//----------------------------------------------------------------------
+
+static inline bool
+Advance(Machine *m, int pcAfter, int loadReg, int loadValue)
+{
+    m->DelayedLoad(loadReg, loadValue);
+    m->registers[PrevPCReg] = m->registers[PCReg];
+    m->registers[PCReg] = m->registers[NextPCReg];
+    m->registers[NextPCReg] = pcAfter;
+    return TRUE;
+}
+
+// Most micro-ops fall through to the next instruction.
+#define SEQUENTIAL(m)	((m)->registers[NextPCReg] + 4)
+
+// The micro-ops themselves.  They follow Machine::ExecuteInstruction
+// line for line; see there for the details.
+
+static bool
+MicroNop(Machine *m, Instruction *instr)	// SLL r0,r0,0 and friends
+{
+    return Advance(m, SEQUENTIAL(m), 0, 0);
+}
+
+static bool
+MicroAddiu(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rt] = m->registers[instr->rs] + instr->extra;
+    return Advance(m, SEQUENTIAL(m), 0, 0);
+}
+
+static bool
+MicroAddu(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rd] = m->registers[instr->rs] +
+	m->registers[instr->rt];
+    return Advance(m, SEQUENTIAL(m), 0, 0);
+}
+
+static bool
+MicroSubu(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rd] = m->registers[instr->rs] -
+	m->registers[instr->rt];
+    return Advance(m, SEQUENTIAL(m), 0, 0);
+}
+
+static bool
+MicroMove(Machine *m, Instruction *instr)	// OR/ADDU rd,rs,r0
+{
+    m->registers[instr->rd] = m->registers[instr->rs];
+    return Advance(m, SEQUENTIAL(m), 0, 0);
+}
+
+static bool
+MicroOr(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rd] = m->registers[instr->rs] |
+	m->registers[instr->rt];
+    return Advance(m, SEQUENTIAL(m), 0, 0);
+}
+
+static bool
+MicroOri(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rt] = m->registers[instr->rs] |
+	(instr->extra & 0xffff);
+    return Advance(m, SEQUENTIAL(m), 0, 0);
+}
+
+static bool
+MicroAnd(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rd] = m->registers[instr->rs] &
+	m->registers[instr->rt];
+    return Advance(m, SEQUENTIAL(m), 0, 0);
+}
+
+static bool
+MicroAndi(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rt] = m->registers[instr->rs] &
+	(instr->extra & 0xffff);
+    return Advance(m, SEQUENTIAL(m), 0, 0);
+}
+
+static bool
+MicroLui(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rt] = instr->extra << 16;
+    return Advance(m, SEQUENTIAL(m), 0, 0);
+}
+
+static bool
+MicroSll(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rd] = m->registers[instr->rt] << instr->extra;
+    return Advance(m, SEQUENTIAL(m), 0, 0);
+}
+
+static bool
+MicroSra(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rd] = m->registers[instr->rt] >> instr->extra;
+    return Advance(m, SEQUENTIAL(m), 0, 0);
+}
+
+static bool
+MicroSrl(Machine *m, Instruction *instr)
+{
+    unsigned int tmp = m->registers[instr->rt];
+
+    m->registers[instr->rd] = tmp >> instr->extra;
+    return Advance(m, SEQUENTIAL(m), 0, 0);
+}
+
+static bool
+MicroSlt(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rd] =
+	(m->registers[instr->rs] < m->registers[instr->rt]) ? 1 : 0;
+    return Advance(m, SEQUENTIAL(m), 0, 0);
+}
+
+static bool
+MicroSlti(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rt] =
+	(m->registers[instr->rs] < instr->extra) ? 1 : 0;
+    return Advance(m, SEQUENTIAL(m), 0, 0);
+}
+
+static bool
+MicroSltu(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rd] = ((unsigned int) m->registers[instr->rs] <
+			       (unsigned int) m->registers[instr->rt]) ? 1 : 0;
+    return Advance(m, SEQUENTIAL(m), 0, 0);
+}
+
+static bool
+MicroSltiu(Machine *m, Instruction *instr)
+{
+    m->registers[instr->rt] = ((unsigned int) m->registers[instr->rs] <
+			       (unsigned int) instr->extra) ? 1 : 0;
+    return Advance(m, SEQUENTIAL(m), 0, 0);
+}
+
+static bool
+MicroLw(Machine *m, Instruction *instr)
+{
+    int addr = m->registers[instr->rs] + instr->extra;
+    int value;
+
+    if (addr & 0x3) {
+	m->RaiseException(AddressErrorException, addr);
+	return FALSE;
+    }
+    if (!m->ReadMem(addr, 4, &value))
+	return FALSE;
+    return Advance(m, SEQUENTIAL(m), instr->rt, value);
+}
+
+static bool
+MicroSw(Machine *m, Instruction *instr)
+{
+    if (!m->WriteMem((unsigned) (m->registers[instr->rs] + instr->extra), 4,
+		     m->registers[instr->rt]))
+	return FALSE;
+    return Advance(m, SEQUENTIAL(m), 0, 0);
+}
+
+static bool
+MicroBeq(Machine *m, Instruction *instr)
+{
+    int pcAfter = SEQUENTIAL(m);
+
+    if (m->registers[instr->rs] == m->registers[instr->rt])
+	pcAfter = m->registers[NextPCReg] + IndexToAddr(instr->extra);
+    return Advance(m, pcAfter, 0, 0);
+}
+
+static bool
+MicroBne(Machine *m, Instruction *instr)
+{
+    int pcAfter = SEQUENTIAL(m);
+
+    if (m->registers[instr->rs] != m->registers[instr->rt])
+	pcAfter = m->registers[NextPCReg] + IndexToAddr(instr->extra);
+    return Advance(m, pcAfter, 0, 0);
+}
+
+static bool
+MicroJ(Machine *m, Instruction *instr)
+{
+    return Advance(m, (SEQUENTIAL(m) & 0xf0000000) |
+		   IndexToAddr(instr->extra), 0, 0);
+}
+
+static bool
+MicroJal(Machine *m, Instruction *instr)
+{
+    int pcAfter = (SEQUENTIAL(m) & 0xf0000000) | IndexToAddr(instr->extra);
+
+    m->registers[R31] = m->registers[NextPCReg] + 4;
+    return Advance(m, pcAfter, 0, 0);
+}
+
+static bool
+MicroJr(Machine *m, Instruction *instr)
+{
+    return Advance(m, m->registers[instr->rs], 0, 0);
+}
+
+//----------------------------------------------------------------------
+// MicroGeneric
+// 	Every other instruction goes through the reference switch.  It
+//	traps if the number of traps changed.
+//----------------------------------------------------------------------
+
+static bool
+MicroGeneric(Machine *m, Instruction *instr)
+{
+    int traps = m->trapCount;
+
+    m->ExecuteInstruction(instr);
+    return m->trapCount == traps;
+}
+
+//----------------------------------------------------------------------
+// SelectMicroOp
+// 	Choose the micro-op executing "instr".  Writes to register 0 are
+//	turned into nops, since DelayedLoad clears r0 anyway, except for
+//	instructions that may trap or that have other effects.
+//----------------------------------------------------------------------
+
+MicroOp
+SelectMicroOp(Instruction *instr)
+{
+    switch (instr->opCode) {
+      case OP_SLL:
+	if (instr->rd == 0)
+	    return MicroNop;
+	return MicroSll;
+      case OP_ADDIU:
+	return (instr->rt == 0) ? MicroNop : MicroAddiu;
+      case OP_ADDU:
+	if (instr->rt == 0)
+	    return MicroMove;
+	return MicroAddu;
+      case OP_OR:
+	if (instr->rt == 0)
+	    return MicroMove;
+	return MicroOr;
+      case OP_SUBU:
+	return MicroSubu;
+      case OP_ORI:
+	return MicroOri;
+      case OP_AND:
+	return MicroAnd;
+      case OP_ANDI:
+	return MicroAndi;
+      case OP_LUI:
+	return MicroLui;
+      case OP_SRA:
+	return MicroSra;
+      case OP_SRL:
+	return MicroSrl;
+      case OP_SLT:
+	return MicroSlt;
+      case OP_SLTI:
+	return MicroSlti;
+      case OP_SLTU:
+	return MicroSltu;
+      case OP_SLTIU:
+	return MicroSltiu;
+      case OP_LW:
+	return MicroLw;
+      case OP_SW:
+	return MicroSw;
+      case OP_BEQ:
+	return MicroBeq;
+      case OP_BNE:
+	return MicroBne;
+      case OP_J:
+	return MicroJ;
+      case OP_JAL:
+	return MicroJal;
+      case OP_JR:
+	return MicroJr;
+      default:
+	return MicroGeneric;
+    }
+}
+
+//----------------------------------------------------------------------
+// Machine::RunMicroOps
+// 	Execute the "len" instructions of a hot block starting at "head"
+//	through their micro-ops.  The caller made sure that "len" silent
+//	ticks are available, so we account for them ourselves.
+//
+//	We stop early if an instruction traps (its tick then goes
+//	through Tick, as in the interpreter loop), or if the block's
+//	frame was written to (InvalidateCode clears fetchFrame).
+//----------------------------------------------------------------------
+
+void
+Machine::RunMicroOps(Instruction *head, int len)
+{
+    MicroOp *ops = decodeCache->MicroOps(head, len);
+    int frame = fetchFrame;
+
+    for (int i = 0; i < len; i++) {
+	if (!(*ops[i])(this, &head[i])) {
+	    Tick();
+	    return;
+	}
+	tickBudget--;
+	pendingTicks++;
+	if (fetchFrame != frame)	// self-modifying code
+	    return;
+    }
+}
+
+//----------------------------------------------------------------------
+// Machine::RunTiered
+// 	The execution loop of the tiered engine; never returns.
+//
+//	Whenever we enter a block at its head, with no pending branch
+//	(NextPCReg is just PCReg + 4), and the block is hot, we run the
+//	whole block with micro-ops.  Otherwise we interpret, exactly as
+//	the loop in Machine::Run.  Micro-ops skip FetchInstruction, so
+//	they are not used when tracing or profiling.
+//----------------------------------------------------------------------
+
+void
+Machine::RunTiered()
+{
+    bool tracing = DebugIsEnabled('m') || profiler != NULL;
+    Instruction *instr;
+    bool atHead;
+    int len;
+
+    for (;;) {
+	atHead = !(fetchLeft > 0 && registers[PCReg] == fetchPC);
+	instr = FetchInstruction();
+	if (instr != NULL) {
+	    len = fetchLeft + 1;
+	    if (atHead && !tracing && tickBudget >= len
+		&& registers[NextPCReg] == registers[PCReg] + 4
+		&& decodeCache->IsHot(instr)) {
+		RunMicroOps(instr, len);
+		ResetFetch();
+		continue;
+	    }
+	    ExecuteInstruction(instr);
+	}
+	Tick();
+	if (singleStep && (runUntilTime <= stats->totalTicks))
+	    Debugger();
+    }
+}
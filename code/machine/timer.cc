@@ -10,6 +10,9 @@
 //      In order to introduce some randomness into time-slicing, if "doRandom"
 //      is set, then the interrupt is comes after a random number of ticks.
 //
+//      The timer can be stopped, and started again: the kernel stops it
+//      when there is no other thread to switch to ("tickless" kernel).
+//
 //	Remember -- nothing in here is part of Nachos.  It is just
 //	an emulation for the hardware that Nachos is running on top of.
 //
@@ -46,10 +49,37 @@ Timer::Timer(VoidFunctionPtr timerHandler, int callArg, bool doRandom)
     randomize = doRandom;
     handler = timerHandler;
     arg = callArg; 
+    next = NULL;
 
     // schedule the first interrupt from the timer device
-    interrupt->Schedule(TimerHandler, (int) this, TimeOfNextInterrupt(), 
-		TimerInt); 
+    Start();
+}
+
+//----------------------------------------------------------------------
+// Timer::Start
+//      Arrange for the timer to generate interrupts, if it is stopped.
+//----------------------------------------------------------------------
+
+void
+Timer::Start()
+{
+    if (next == NULL)
+	next = interrupt->Schedule(TimerHandler, (int) this,
+				   TimeOfNextInterrupt(), TimerInt);
+}
+
+//----------------------------------------------------------------------
+// Timer::Stop
+//      Stop the timer: cancel its next interrupt, if any.
+//----------------------------------------------------------------------
+
+void
+Timer::Stop()
+{
+    if (next != NULL) {
+	interrupt->Cancel(next);
+	next = NULL;
+    }
 }
 
 //----------------------------------------------------------------------
@@ -62,8 +92,8 @@ void
 Timer::TimerExpired() 
 {
     // schedule the next timer device interrupt
-    interrupt->Schedule(TimerHandler, (int) this, TimeOfNextInterrupt(), 
-		TimerInt);
+    next = NULL;
+    Start();
 
     // invoke the Nachos interrupt handler for this device
     (*handler)(arg);
@@ -23,6 +23,8 @@
 #include "copyright.h"
 #include "utility.h"
 
+class PendingInterrupt;
+
 // The following class defines a hardware timer. 
 class Timer {
   public:
@@ -31,6 +33,10 @@ class Timer {
 				// handler "timerHandler" every time slice.
     ~Timer() {}
 
+    void Start();		// Generate interrupts again, if stopped
+    void Stop();		// Stop generating interrupts
+    bool IsRunning() { return next != NULL; }
+
 // Internal routines to the timer emulation -- DO NOT call these
 
     void TimerExpired();	// called internally when the hardware
@@ -43,6 +49,7 @@ class Timer {
     bool randomize;		// set if we need to use a random timeout delay
     VoidFunctionPtr handler;	// timer interrupt handler 
     int arg;			// argument to pass to interrupt handler
+    PendingInterrupt *next;	// next interrupt, NULL if stopped
 
 };
 
@@ -90,13 +90,21 @@ Machine::ReadMem(int addr, int size, int *value)
     int data;
     ExceptionType exception;
     int physicalAddress;
+    unsigned int vpn = (unsigned) addr / PageSize;
+    TranslationCacheEntry *cached = &transCache[vpn % TransCacheSize];
+
+    if (cached->vpn == vpn && (addr & (size - 1)) == 0) {
+	physicalAddress = cached->frameBase + (unsigned) addr % PageSize;
+	cached->entry->use = TRUE;
+    } else {
+	DEBUG('a', "Reading VA 0x%x, size %d\n", addr, size);
     
-    DEBUG('a', "Reading VA 0x%x, size %d\n", addr, size);
-    
-    exception = Translate(addr, &physicalAddress, size, FALSE);
-    if (exception != NoException) {
-	machine->RaiseException(exception, addr);
-	return FALSE;
+	exception = Translate(addr, &physicalAddress, size, FALSE);
+	if (exception != NoException) {
+	    machine->RaiseException(exception, addr);
+	    return FALSE;
+	}
+	CacheTranslation(addr, physicalAddress, FALSE);
     }
     switch (size) {
       case 1:
@@ -139,13 +147,32 @@ Machine::WriteMem(int addr, int size, int value)
 {
     ExceptionType exception;
     int physicalAddress;
-     
-    DEBUG('a', "Writing VA 0x%x, size %d, value 0x%x\n", addr, size, value);
+    unsigned int vpn = (unsigned) addr / PageSize;
+    TranslationCacheEntry *cached = &transCache[vpn % TransCacheSize];
 
-    exception = Translate(addr, &physicalAddress, size, TRUE);
-    if (exception != NoException) {
-	machine->RaiseException(exception, addr);
-	return FALSE;
+    if (cached->vpn == vpn && !cached->readOnly && (addr & (size - 1)) == 0) {
+	physicalAddress = cached->frameBase + (unsigned) addr % PageSize;
+	cached->entry->use = TRUE;
+	cached->entry->dirty = TRUE;
+    } else {
+	DEBUG('a', "Writing VA 0x%x, size %d, value 0x%x\n", addr, size, value);
+
+	exception = Translate(addr, &physicalAddress, size, TRUE);
+	if (exception != NoException) {
+	    machine->RaiseException(exception, addr);
+	    return FALSE;
+	}
+	CacheTranslation(addr, physicalAddress, TRUE);
+    }
+    InvalidateCode(physicalAddress / PageSize);	// in case it holds code
+    if (capturing) {				// lockstep check: log the store
+	ASSERT(numStores < 2);
+	storeLog[numStores].physAddr = physicalAddress;
+	storeLog[numStores].size = size;
+	storeLog[numStores].before = 0;
+	storeLog[numStores].after = 0;
+	memcpy(&storeLog[numStores].before,
+	       &machine->mainMemory[physicalAddress], size);
     }
     switch (size) {
       case 1:
@@ -164,10 +191,192 @@ Machine::WriteMem(int addr, int size, int value)
 	
       default: ASSERT(FALSE);
     }
-    
+
+    if (capturing) {
+	memcpy(&storeLog[numStores].after,
+	       &machine->mainMemory[physicalAddress], size);
+	numStores++;
+    }
     return TRUE;
 }
 
+//----------------------------------------------------------------------
+// Machine::TranslateSpan
+//      Translate the first page of the span of "*size" bytes at
+//	"virtAddr", for the Copy routines below.  On return "*size" is
+//	cut to the part of the span lying in that page.
+//
+//	If the translation fails, the exception is raised as for an
+//	instruction, so that the kernel can fix it (by paging in the
+//	page, for instance), and the translation is tried once more.
+//
+//   	Returns FALSE if the page still cannot be translated.
+//----------------------------------------------------------------------
+
+bool
+Machine::TranslateSpan(int virtAddr, int *physAddr, int *size, bool writing)
+{
+    ExceptionType exception;
+    int inPage = PageSize - (unsigned) virtAddr % PageSize;
+
+    if (*size > inPage)
+	*size = inPage;
+    DEBUG('a', "%s %d bytes at VA 0x%x\n", writing ? "Copying out" :
+	  "Copying in", *size, virtAddr);
+    exception = Translate(virtAddr, physAddr, 1, writing);
+    if (exception != NoException) {
+	RaiseException(exception, virtAddr);
+	exception = Translate(virtAddr, physAddr, 1, writing);
+    }
+    return (exception == NoException);
+}
+
+//----------------------------------------------------------------------
+// Machine::CopyFromUser
+//      Copy "size" bytes of user virtual memory at "virtAddr" into the
+//	kernel "buffer", one page at a time: each page is translated
+//	once, then copied with memcpy.
+//
+//   	Returns FALSE if some page could not be translated; "buffer" then
+//	only holds the part of the data preceding that page.
+//----------------------------------------------------------------------
+
+bool
+Machine::CopyFromUser(int virtAddr, char *buffer, int size)
+{
+    int physAddr, chunk;
+
+    while (size > 0) {
+	chunk = size;
+	if (!TranslateSpan(virtAddr, &physAddr, &chunk, FALSE))
+	    return FALSE;
+	memcpy(buffer, &mainMemory[physAddr], chunk);
+	virtAddr += chunk;
+	buffer += chunk;
+	size -= chunk;
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Machine::CopyToUser
+//      Copy "size" bytes of the kernel "buffer" into user virtual memory
+//	at "virtAddr", one page at a time.  The decoded copy of any page
+//	written is dropped, as in WriteMem.
+//
+//   	Returns FALSE if some page could not be translated (or is
+//	read-only); the pages preceding it have then been written.
+//----------------------------------------------------------------------
+
+bool
+Machine::CopyToUser(int virtAddr, const char *buffer, int size)
+{
+    int physAddr, chunk;
+
+    while (size > 0) {
+	chunk = size;
+	if (!TranslateSpan(virtAddr, &physAddr, &chunk, TRUE))
+	    return FALSE;
+	InvalidateCode(physAddr / PageSize);
+	memcpy(&mainMemory[physAddr], buffer, chunk);
+	virtAddr += chunk;
+	buffer += chunk;
+	size -= chunk;
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Machine::CopyStringFromUser
+//      Copy the NUL-terminated string at "virtAddr" in user virtual
+//	memory into the kernel "buffer", of "size" bytes.  At most
+//	size - 1 characters are copied, and the result is always
+//	NUL-terminated.  Pages after the one holding the end of the
+//	string are not touched.
+//
+//   	Returns the length of the string copied, or -1 if some page could
+//	not be translated.
+//----------------------------------------------------------------------
+
+int
+Machine::CopyStringFromUser(int virtAddr, char *buffer, int size)
+{
+    int physAddr, chunk, length = 0;
+    char *end;
+
+    ASSERT(size > 0);
+    size--;				// room for the NUL
+    while (size > 0) {
+	chunk = size;
+	if (!TranslateSpan(virtAddr, &physAddr, &chunk, FALSE)) {
+	    buffer[length] = '\0';
+	    return -1;
+	}
+	end = (char *) memchr(&mainMemory[physAddr], '\0', chunk);
+	if (end != NULL)
+	    chunk = end - &mainMemory[physAddr];
+	memcpy(buffer + length, &mainMemory[physAddr], chunk);
+	length += chunk;
+	if (end != NULL)
+	    break;
+	virtAddr += chunk;
+	size -= chunk;
+    }
+    buffer[length] = '\0';
+    return length;
+}
+
+//----------------------------------------------------------------------
+// Machine::CacheTranslation
+//      Remember that "virtAddr" was just translated to "physAddr" by
+//	Translate, so that the next accesses to the same page skip it.
+//	We look the page table or TLB entry up again (Translate does not
+//	return it), which only happens on a miss.
+//
+//	"writing" -- TRUE if the translation was checked for a write
+//----------------------------------------------------------------------
+
+void
+Machine::CacheTranslation(int virtAddr, int physAddr, bool writing)
+{
+    unsigned int vpn = (unsigned) virtAddr / PageSize;
+    TranslationCacheEntry *cached = &transCache[vpn % TransCacheSize];
+    TranslationEntry *entry = NULL;
+    int i;
+
+    if (!cacheTranslations)
+	return;
+    if (tlb == NULL)
+	entry = &pageTable[vpn];
+    else {
+	for (i = 0; i < TLBSize; i++)
+	    if (tlb[i].valid && (tlb[i].virtualPage == vpn)) {
+		entry = &tlb[i];
+		break;
+	    }
+	ASSERT(entry != NULL);
+    }
+    cached->vpn = vpn;
+    cached->frameBase = physAddr - (unsigned) virtAddr % PageSize;
+    cached->entry = entry;
+    cached->readOnly = entry->readOnly;
+}
+
+//----------------------------------------------------------------------
+// Machine::FlushTranslationCache
+//      Forget every cached translation.  Called on every trap into the
+//	kernel (which may edit the page table or the TLB), and whenever
+//	the kernel switches page tables (AddrSpace::RestoreState, and the
+//	temporary switch done when loading a program).
+//----------------------------------------------------------------------
+
+void
+Machine::FlushTranslationCache()
+{
+    for (int i = 0; i < TransCacheSize; i++)
+	transCache[i].vpn = InvalidVPN;
+}
+
 //----------------------------------------------------------------------
 // Machine::Translate
 // 	Translate a virtual address into a physical address, using 
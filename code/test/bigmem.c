@@ -0,0 +1,33 @@
+/* bigmem.c
+ *	Fill an array bigger than the physical memory, then check it,
+ *	twice over: the pages written first must have been evicted to
+ *	the swap space, and brought back intact.  Another big array is
+ *	never touched, and should never be brought in: see "Paging" in
+ *	the statistics at halt.
+ */
+
+#include "syscall.h"
+
+#define WORDS (160 * 128 / 4)	/* 160 pages, NumPhysPages is 128 */
+#define ROUNDS 2
+
+int big[WORDS];
+int unused[WORDS];
+
+int main()
+{
+  int errors = 0;
+
+  for (int round = 0; round < ROUNDS; round++) {
+    for (int i = 0; i < WORDS; i++)
+      big[i] = i * 7 + round;
+    for (int i = 0; i < WORDS; i++)
+      if (big[i] != i * 7 + round)
+        errors++;
+  }
+  SynchPutString("bigmem: ");
+  SynchPutInt(errors);
+  SynchPutString(" errors\n");
+  Halt();
+  return 0;
+}
@@ -0,0 +1,45 @@
+/* cowfork.c
+ *	Fork a copy of this program, then have the child rewrite an
+ *	array that the parent filled, while the parent reads it back and
+ *	writes to part of it.  Each one must only see its own writes: the
+ *	pages are shared until written, then copied (see Pager::Fork).
+ *	Run with -rs to mix the two up.
+ */
+
+#include "syscall.h"
+
+#define WORDS (8 * 128 / 4)	/* 8 pages */
+
+int array[WORDS];
+
+int main()
+{
+  int errors = 0;
+  int child;
+
+  for (int i = 0; i < WORDS; i++)
+    array[i] = i;
+  child = Fork();
+  if (child == 0) {
+    for (int i = 0; i < WORDS; i++)
+      array[i] = -i;
+    for (int i = 0; i < WORDS; i++)
+      if (array[i] != -i)
+        errors++;
+    SynchPutString("cowfork child: ");
+  } else {
+    for (int i = 0; i < WORDS; i++)
+      if (array[i] != i)
+        errors++;
+    for (int i = 0; i < WORDS / 2; i++)
+      array[i] = i + 1;
+    for (int i = 0; i < WORDS; i++)
+      if (array[i] != (i < WORDS / 2 ? i + 1 : i))
+        errors++;
+    SynchPutString("cowfork parent: ");
+  }
+  SynchPutInt(errors);
+  SynchPutString(" errors\n");
+  Halt();
+  return 0;
+}
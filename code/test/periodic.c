@@ -0,0 +1,41 @@
+/* periodic.c
+ *	A real-time thread woken up every PERIOD ticks by Sleep, while
+ *	another thread computes all the time.  The real-time thread
+ *	preempts the other one as soon as it wakes up, so it should not
+ *	miss any deadline: see "Real-time" in the statistics at halt.
+ */
+
+#include "syscall.h"
+
+#define PERIOD 2000
+#define BUDGET 500
+#define ROUNDS 10
+
+int done = 0;
+
+void hog(int unused)
+{
+  int x = 0;
+
+  while (!done)
+    x = x * 3 + 1;
+  UserThreadExit();
+}
+
+int main()
+{
+  int t = UserThreadCreate(hog, (void *) 0);
+
+  if (SetRealTime(PERIOD, BUDGET) < 0)
+    SynchPutString("SetRealTime refused\n");
+  for (int i = 0; i < ROUNDS; i++) {
+    SynchPutString("period ");
+    SynchPutInt(i);
+    SynchPutString("\n");
+    Sleep(PERIOD);
+  }
+  done = 1;
+  UserThreadJoin(t);
+  Halt();
+  return 0;
+}
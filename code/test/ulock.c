@@ -0,0 +1,91 @@
+/* ulock.c
+ *	Mutexes and condition variables for user programs (see ulock.h).
+ *
+ *	The mutex is the one of U. Drepper, "Futexes Are Tricky": its
+ *	word is 0 when free, 1 when locked, and 2 when locked with
+ *	threads (maybe) sleeping on it, so that MutexUnlock only calls
+ *	FutexWake in the last case.
+ */
+
+#include "syscall.h"
+#include "ulock.h"
+
+/* Store "value" into *addr, and return the former value. */
+static int Exchange(int *addr, int value)
+{
+  int old;
+
+  do
+    old = *addr;
+  while (CompareAndSwap(addr, old, value) != old);
+  return old;
+}
+
+/* Add "delta" to *addr, and return the former value. */
+static int FetchAndAdd(int *addr, int delta)
+{
+  int old;
+
+  do
+    old = *addr;
+  while (CompareAndSwap(addr, old, old + delta) != old);
+  return old;
+}
+
+void MutexInit(Mutex *m)
+{
+  m->state = 0;
+}
+
+void MutexLock(Mutex *m)
+{
+  int c = CompareAndSwap(&m->state, 0, 1);
+
+  if (c == 0)
+    return;			/* uncontended: no system call */
+  if (c != 2)
+    c = Exchange(&m->state, 2);
+  while (c != 0) {
+    FutexWait(&m->state, 2);
+    c = Exchange(&m->state, 2);
+  }
+}
+
+int MutexTryLock(Mutex *m)
+{
+  return CompareAndSwap(&m->state, 0, 1) == 0;
+}
+
+void MutexUnlock(Mutex *m)
+{
+  if (FetchAndAdd(&m->state, -1) != 1) {
+    m->state = 0;		/* somebody may wait */
+    FutexWake(&m->state, 1);
+  }
+}
+
+void CondInit(CondVar *c)
+{
+  c->seq = 0;
+}
+
+void CondWait(CondVar *c, Mutex *m)
+{
+  int seq = c->seq;
+
+  MutexUnlock(m);
+  FutexWait(&c->seq, seq);	/* returns at once if signalled since */
+  MutexLock(m);
+}
+
+void CondSignal(CondVar *c)
+{
+  FetchAndAdd(&c->seq, 1);
+  FutexWake(&c->seq, 1);
+}
+
+void CondBroadcast(CondVar *c)
+{
+  FetchAndAdd(&c->seq, 1);
+  FutexWake(&c->seq, 0x7fffffff);
+}
@@ -0,0 +1,35 @@
+/* ulock.h
+ *	Mutexes and condition variables for user programs, built on
+ *	CompareAndSwap and the FutexWait/FutexWake system calls.
+ *
+ *	Taking a free mutex, or releasing one nobody waits for, costs no
+ *	system call.  Link a program with ulock.c to use them.
+ */
+
+#ifndef ULOCK_H
+#define ULOCK_H
+
+/* 0: free, 1: locked, 2: locked, and maybe waited for */
+typedef struct {
+  int state;
+} Mutex;
+
+/* bumped at each signal, so that a waiter that missed it does not sleep */
+typedef struct {
+  int seq;
+} CondVar;
+
+#define MUTEX_INITIALIZER { 0 }
+#define CONDVAR_INITIALIZER { 0 }
+
+void MutexInit(Mutex *m);
+void MutexLock(Mutex *m);
+int MutexTryLock(Mutex *m);	/* 1 if taken, 0 if busy */
+void MutexUnlock(Mutex *m);
+
+void CondInit(CondVar *c);
+void CondWait(CondVar *c, Mutex *m);
+void CondSignal(CondVar *c);
+void CondBroadcast(CondVar *c);
+
+#endif /* ULOCK_H */
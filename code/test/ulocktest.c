@@ -0,0 +1,68 @@
+/* ulocktest.c
+ *	Test the user mutexes and condition variables (ulock.c): worker
+ *	threads add to a shared counter under a mutex, and hand items to
+ *	the main thread through a one-slot buffer guarded by a condition
+ *	variable.  Run it with "-rs" so that threads are switched out at
+ *	random, also in the middle of CompareAndSwap.
+ */
+
+#include "syscall.h"
+#include "ulock.h"
+
+#define WORKERS 4
+#define ROUNDS 200
+
+Mutex lock = MUTEX_INITIALIZER;
+CondVar changed = CONDVAR_INITIALIZER;
+int counter = 0;
+int slot = 0;			/* 0 when empty */
+
+void worker(int id)
+{
+  for (int i = 0; i < ROUNDS; i++) {
+    MutexLock(&lock);
+    int c = counter;		/* a lost update would show below */
+    for (int j = 0; j < 10; j++)
+      ;
+    counter = c + 1;
+    MutexUnlock(&lock);
+  }
+
+  MutexLock(&lock);
+  while (slot != 0)
+    CondWait(&changed, &lock);
+  slot = id;
+  CondBroadcast(&changed);
+  MutexUnlock(&lock);
+  UserThreadExit();
+}
+
+int main()
+{
+  int tids[WORKERS];
+  int sum = 0;
+
+  for (int i = 0; i < WORKERS; i++)
+    tids[i] = UserThreadCreate(worker, (void *) (i + 1));
+
+  for (int i = 0; i < WORKERS; i++) {
+    MutexLock(&lock);
+    while (slot == 0)
+      CondWait(&changed, &lock);
+    sum += slot;
+    slot = 0;
+    CondBroadcast(&changed);
+    MutexUnlock(&lock);
+  }
+  for (int i = 0; i < WORKERS; i++)
+    UserThreadJoin(tids[i]);
+
+  SynchPutString("counter: ");
+  SynchPutInt(counter);
+  SynchPutString(counter == WORKERS * ROUNDS ? " (ok)\n" : " (WRONG)\n");
+  SynchPutString("handed over: ");
+  SynchPutInt(sum);
+  SynchPutString(sum == WORKERS * (WORKERS + 1) / 2 ? " (ok)\n" : " (WRONG)\n");
+  Halt();
+  return 0;
+}
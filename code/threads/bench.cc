@@ -0,0 +1,226 @@
+// bench.cc
+//	Micro-benchmarks of the kernel and of the machine simulation,
+//	run with "nachos -bench <name>".  Each one prints its own
+//	measurements, in host time (and simulated time, when it makes
+//	sense), then Nachos halts.
+//
+//	"events" -- schedules and fires 10^6 interrupts, with a few
+//		populations of pending interrupts, cancelling some of
+//		them on the way (see EventBenchmark).
+//
+//	"switch" -- measures a context switch, between kernel threads
+//		and, given a user program, between user threads in the
+//		same address space and in different ones (see
+//		SwitchBenchmark).
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "synch.h"
+#ifdef USER_PROGRAM
+#include "addrspace.h"
+#endif
+
+#define BenchEvents	1000000	// interrupts fired per population
+#define BenchMaxDelay	1000	// interrupts are due 1 to this many
+				// ticks after being scheduled
+#define BenchCancel	4	// one firing out of this many also
+				// cancels a pending interrupt
+#define BenchYields	100000	// yields per thread, when measuring
+				// context switches
+
+static PendingInterrupt **benchPending;	// handle of each pending
+					// interrupt, by slot
+static int benchFired;			// interrupts fired so far
+static int benchCancelled;		// interrupts cancelled so far
+
+//----------------------------------------------------------------------
+// BenchEvent
+// 	Interrupt handler of the events benchmark.  Count the interrupt,
+//	then schedule the next one for the same slot, so that the number
+//	of pending interrupts stays constant.  Now and then, also cancel
+//	the interrupt of another slot, and schedule it again.
+//
+//	"slot" is the slot of the interrupt that fired
+//----------------------------------------------------------------------
+
+static void
+BenchEvent(int slot)
+{
+    benchFired++;
+    benchPending[slot] = interrupt->Schedule(BenchEvent, slot,
+				1 + Random() % BenchMaxDelay, TimerInt);
+    if ((benchFired % BenchCancel) == 0) {
+	int other = (slot + 1 + benchFired) % BenchMaxDelay;
+
+	if (benchPending[other] != NULL) {
+	    interrupt->Cancel(benchPending[other]);
+	    benchCancelled++;
+	    benchPending[other] = interrupt->Schedule(BenchEvent, other,
+				1 + Random() % BenchMaxDelay, TimerInt);
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// EventRun
+// 	Fire BenchEvents interrupts with "population" of them pending at
+//	any time, and print how long it took.  Time is advanced as when
+//	no thread is ready, by Interrupt::Idle, straight to the next
+//	interrupt due.
+//----------------------------------------------------------------------
+
+static void
+EventRun(int population)
+{
+    long long start, elapsed, ticks = stats->totalTicks;
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    int slots = (population > BenchMaxDelay) ? population : BenchMaxDelay;
+
+    benchPending = new PendingInterrupt *[slots];
+    for (int i = 0; i < slots; i++)
+	benchPending[i] = (i < population) ?
+	    interrupt->Schedule(BenchEvent, i, 1 + Random() % BenchMaxDelay,
+				TimerInt) : NULL;
+    benchFired = 0;
+    benchCancelled = 0;
+
+    start = HostMicroseconds();
+    while (benchFired < BenchEvents)
+	interrupt->Idle();
+    elapsed = HostMicroseconds() - start;
+
+    printf("events: %7d pending, %d fired, %d cancelled in %lld ticks: "
+	   "%lld us, %lld ns per event\n", population, benchFired,
+	   benchCancelled, stats->totalTicks - ticks, elapsed,
+	   elapsed * 1000 / benchFired);
+
+    for (int i = 0; i < population; i++)
+	interrupt->Cancel(benchPending[i]);
+    delete [] benchPending;
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// EventBenchmark
+// 	Measure the cost of scheduling, firing and cancelling interrupts,
+//	for a small, a medium and a large number of pending interrupts.
+//----------------------------------------------------------------------
+
+static void
+EventBenchmark()
+{
+    EventRun(10);
+    EventRun(1000);
+    EventRun(100000);
+}
+
+static Semaphore *benchYieldersDone;	// V'ed by each thread yielding
+
+//----------------------------------------------------------------------
+// BenchYielder
+// 	Body of the threads of the switch benchmark: yield the CPU over
+//	and over.
+//
+//	"yields" is how many times to yield
+//----------------------------------------------------------------------
+
+static void
+BenchYielder(int yields)
+{
+    for (int i = 0; i < yields; i++)
+	currentThread->Yield();
+    benchYieldersDone->V();
+}
+
+//----------------------------------------------------------------------
+// SwitchRun
+// 	Have two threads yield to each other BenchYields times each, and
+//	print the host time per context switch.  The threads run in
+//	"space1" and "space2" (NULL for a kernel thread), so that the
+//	switches also save and restore the user registers and the page
+//	table, as they would for user threads.
+//
+//	"what" describes the threads.
+//----------------------------------------------------------------------
+
+static void
+SwitchRun(const char *what, AddrSpace *space1, AddrSpace *space2)
+{
+    Thread *t1 = new Thread("yielder 1"), *t2 = new Thread("yielder 2");
+    long long start, elapsed;
+    int switches = stats->numContextSwitches;
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    benchYieldersDone = new Semaphore("yielders done", 0);
+    t1->Fork(BenchYielder, BenchYields);
+    t2->Fork(BenchYielder, BenchYields);
+#ifdef USER_PROGRAM
+    t1->space = space1;			// Fork gave them our own space
+    t2->space = space2;
+#endif
+    (void) interrupt->SetLevel(oldLevel);
+
+    start = HostMicroseconds();
+    benchYieldersDone->P();
+    benchYieldersDone->P();
+    elapsed = HostMicroseconds() - start;
+    switches = stats->numContextSwitches - switches;
+
+    printf("switch: %-28s %d switches: %lld us, %lld ns per switch\n",
+	   what, switches, elapsed, elapsed * 1000 / switches);
+    delete benchYieldersDone;
+}
+
+//----------------------------------------------------------------------
+// SwitchBenchmark
+// 	Measure the cost of Thread::Yield, between kernel threads, then,
+//	if "program" is given, between threads in one address space
+//	loaded from it, and between threads in two such address spaces.
+//----------------------------------------------------------------------
+
+static void
+SwitchBenchmark(const char *program)
+{
+    SwitchRun("kernel threads,", NULL, NULL);
+#ifdef USER_PROGRAM
+    OpenFile *executable1, *executable2;	// each address space closes
+    AddrSpace *space1, *space2;			// its own
+
+    if (program == NULL)
+	return;
+    if ((executable1 = fileSystem->Open(program)) == NULL) {
+	printf("Unable to open file %s\n", program);
+	return;
+    }
+    executable2 = fileSystem->Open(program);
+    space1 = new AddrSpace(executable1);
+    space2 = new AddrSpace(executable2);
+
+    SwitchRun("user threads, same space,", space1, space1);
+    SwitchRun("user threads, two spaces,", space1, space2);
+    delete space2;
+    delete space1;
+#endif
+}
+
+//----------------------------------------------------------------------
+// Benchmark
+// 	Run the benchmark called "name".
+//
+//	"arg" is the argument of the benchmark, NULL if none
+//----------------------------------------------------------------------
+
+void
+Benchmark(const char *name, const char *arg)
+{
+    if (!strcmp(name, "events"))
+	EventBenchmark();
+    else if (!strcmp(name, "switch"))
+	SwitchBenchmark(arg);
+    else
+	fprintf(stderr, "Unknown benchmark %s\n", name);
+}
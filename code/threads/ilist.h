@@ -0,0 +1,160 @@
+// ilist.h
+//	Data structures to manage "intrusive" lists: lists whose items
+//	carry their own links, so that putting an item on a list, or
+//	taking it off, never allocates memory.
+//
+//	List (see list.h) allocates a ListElement for every item it
+//	holds.  That is fine for occasional use, but the ready list, the
+//	semaphore queues and the mailboxes are updated at every context
+//	switch or message, and there the allocations show.
+//
+//	An item of type T can go on an IntrusiveList<T> if T has a public
+//	member "ListLink<T> listLink".  The link holds the item on one
+//	list at a time: for instance, a thread is either on a ready list
+//	or waiting on a synchronization object, never both.
+//
+//	The lists are doubly linked, so that an item can also be taken
+//	off from the middle of its list.
+//
+//	Everything is inline, since IntrusiveList is a template.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef ILIST_H
+#define ILIST_H
+
+#include "copyright.h"
+#include "utility.h"
+
+// The following class defines the links of an item on an intrusive
+// list.  They are left public, as in ListElement, so that the list
+// operations can access them directly.
+
+template <class T>
+class ListLink
+{
+  public:
+    ListLink () { next = prev = NULL; item = NULL; }
+
+    bool IsLinked () { return next != NULL; }	// is the item on a list?
+
+    ListLink<T> *next;		// next link on the list, NULL if the
+				// item is not on a list
+    ListLink<T> *prev;		// previous link on the list
+    T *item;			// the item holding this link
+};
+
+// The following class defines an intrusive list of items of type T.
+// The list is circular: a "head" link, holding no item, precedes the
+// first item and follows the last one.
+
+template <class T>
+class IntrusiveList
+{
+  public:
+    IntrusiveList ()		// initialize the list
+    {
+	head.next = head.prev = &head;
+	numItems = 0;
+    }
+
+    void Append (T *item)	// Put item at the end of the list
+    {
+	Link (item, head.prev);
+    }
+    void Prepend (T *item)	// Put item at the beginning of the list
+    {
+	Link (item, &head);
+    }
+    T *Remove ()		// Take item off the front of the list,
+    {				// NULL if the list is empty
+	T *item = head.next->item;
+
+	if (item != NULL)
+	    Unlink (item);
+	return item;
+    }
+    void Unlink (T *item);	// Take item off the list, wherever it is
+
+    T *First ()			// First item, left on the list
+    {
+	return head.next->item;
+    }
+    bool IsEmpty ()
+    {
+	return numItems == 0;
+    }
+    int NumItems ()
+    {
+	return numItems;
+    }
+
+    void Mapcar (VoidFunctionPtr func);	// Apply "func" to every item
+    // on the list
+
+  private:
+    ListLink<T> head;		// holds no item
+    int numItems;		// number of items on the list
+
+    void Link (T *item, ListLink<T> *after);	// put item after "after"
+};
+
+//----------------------------------------------------------------------
+// IntrusiveList<T>::Link
+//      Put "item", which must not be on a list, after the link "after"
+//      of this list.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+IntrusiveList<T>::Link (T *item, ListLink<T> *after)
+{
+    ListLink<T> *link = &item->listLink;
+
+    ASSERT (!link->IsLinked ());
+    link->item = item;
+    link->prev = after;
+    link->next = after->next;
+    after->next->prev = link;
+    after->next = link;
+    numItems++;
+}
+
+//----------------------------------------------------------------------
+// IntrusiveList<T>::Unlink
+//      Take "item", which must be on this list, off the list.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+IntrusiveList<T>::Unlink (T *item)
+{
+    ListLink<T> *link = &item->listLink;
+
+    ASSERT (link->IsLinked ());
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+    link->next = link->prev = NULL;
+    numItems--;
+}
+
+//----------------------------------------------------------------------
+// IntrusiveList<T>::Mapcar
+//      Apply a function to each item on the list, by walking through
+//      the list, one item at a time.
+//
+//      "func" is the procedure to apply; it gets the item as an int,
+//      as with List::Mapcar.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+IntrusiveList<T>::Mapcar (VoidFunctionPtr func)
+{
+    for (ListLink<T> *link = head.next; link != &head; link = link->next)
+	(*func) ((int) link->item);
+}
+
+#endif // ILIST_H
@@ -59,6 +59,8 @@ class List
     // Routines to put/get items on/off list in order (sorted by key)
     void SortedInsert (void *item, long long sortKey);	// Put item into list
     void *SortedRemove (long long *keyPtr);	// Remove first item from list
+    void *SortedPeek (long long *keyPtr);	// Look at first item, leave
+					// it on the list
 
   private:
       ListElement * first;	// Head of the list, NULL if list is empty
@@ -9,7 +9,11 @@
 //      Most of this file is not needed until later assignments.
 //
 // Usage: nachos -d <debugflags> -rs <random seed #>
-//              -s -x <nachos file> -c <consoleIn> <consoleOut>
+//              -sched <policy> -bench <benchmark> [<nachos file>]
+//              -s -engine <engine> -prof <stacks file> -x <nachos file>
+//              -replace <policy> -frames <#frames>
+//              -fuzz <#instructions>
+//              -c <consoleIn> <consoleOut>
 //              -f -cp <unix file> <nachos file>
 //              -p <nachos file> -r <nachos file> -l -D -t
 //              -n <network reliability> -m <machine id>
@@ -18,11 +22,31 @@
 //
 //    -d causes certain debugging messages to be printed (cf. utility.h)
 //    -rs causes Yield to occur at random (but repeatable) spots
+//    -sched selects the scheduling policy: "fifo" (the default),
+//       "prio" (static priorities) or "mlfq" (multilevel feedback
+//       queue), see policy.h
+//    -bench runs a micro-benchmark (see bench.cc), then halts; the
+//       "switch" benchmark also switches between user threads of the
+//       given program
 //    -z prints the copyright message
 //
 //  USER_PROGRAM
 //    -s causes user programs to be executed in single-step mode
+//    -engine selects how user instructions are executed: "switch"
+//       (reference interpreter), "threaded" (the default),
+//       "lockstep" (all of them, checking that they agree), or
+//       "tiered" (hot blocks run as specialized micro-ops)
+//    -prof profiles user programs: prints a flat profile when the
+//       machine halts, and writes the call chains to <stacks file>
+//       for flame graph tools
 //    -x runs a user program
+//    -replace selects the page replacement policy: "fifo" (the
+//       default), "clock", "second" (second chance), "wsclock" or
+//       "lru" (sampled LRU), see vm/replace.h
+//    -frames limits the physical memory given to user programs, to
+//       see how they fare with less of it
+//    -fuzz checks the engines against each other on random
+//       instructions, as "-engine lockstep" does on real programs
 //    -c tests the console
 //
 //  FILESYS
@@ -61,6 +85,7 @@ extern void Print (char *file), PerformanceTest (void);
 extern void StartProcess (char *file), ConsoleTest (char *in, char *out);
 extern void MailTest (int networkID);
 extern void SynchConsoleTest(char *in, char *out);
+extern void Benchmark (const char *name, const char *arg);
 
 //----------------------------------------------------------------------
 // main
@@ -94,6 +119,14 @@ main (int argc, char **argv)
 	  argCount = 1;
 	  if (!strcmp (*argv, "-z"))	// print copyright
 	      printf ("%s", copyright);
+	  if (!strcmp (*argv, "-bench"))
+	    {			// run a micro-benchmark
+		ASSERT (argc > 1);
+		Benchmark (*(argv + 1), (argc > 2 && (*(argv + 2))[0] != '-')
+			   ? *(argv + 2) : (const char *) NULL);
+		argCount = 2;
+		interrupt->Halt ();
+	    }
 #ifdef USER_PROGRAM
 	  if (!strcmp (*argv, "-x"))
 	    {			// run a user program
@@ -101,6 +134,13 @@ main (int argc, char **argv)
 		StartProcess (*(argv + 1));
 		argCount = 2;
 	    }
+	  else if (!strcmp (*argv, "-fuzz"))
+	    {			// check the engines on random code
+		ASSERT (argc > 1);
+		machine->Fuzz (atoi (*(argv + 1)));
+		argCount = 2;
+		interrupt->Halt ();
+	    }
 	  else if (!strcmp (*argv, "-c"))
 	    {			// test the console
 		if (argc == 1)
@@ -0,0 +1,333 @@
+// policy.cc
+//      Routines implementing the scheduling policies: FIFO, static
+//      priorities and multilevel feedback queue, and the queue of the
+//      real-time threads.
+//
+//      These routines assume that interrupts are already disabled
+//      (see scheduler.cc).
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "policy.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// NewReadyQueue
+//      Create an empty queue of ready threads, following "policy".
+//----------------------------------------------------------------------
+
+ReadyQueue *
+NewReadyQueue (SchedulingPolicy policy)
+{
+    switch (policy)
+      {
+      case SchedPriority:
+	  return new PriorityQueue ();
+      case SchedMlfq:
+	  return new MlfqQueue ();
+      default:
+	  return new FifoQueue ();
+      }
+}
+
+//----------------------------------------------------------------------
+// ReadyQueue::Tick
+//      The timer interrupted "running".  By default, every timer
+//      interrupt ends a time slice.
+//----------------------------------------------------------------------
+
+bool
+ReadyQueue::Tick (Thread * running)
+{
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// ReadyQueue::IoWait
+//      "thread" is about to wait for a device.  By default, nothing to
+//      do.
+//----------------------------------------------------------------------
+
+void
+ReadyQueue::IoWait (Thread * thread)
+{
+}
+
+//----------------------------------------------------------------------
+// FifoQueue
+//      The ready threads, in the order they became ready.
+//----------------------------------------------------------------------
+
+void
+FifoQueue::Put (Thread * thread)
+{
+    ready.Append (thread);
+}
+
+Thread *
+FifoQueue::Get ()
+{
+    return ready.Remove ();
+}
+
+int
+FifoQueue::NumReady ()
+{
+    return ready.NumItems ();
+}
+
+void
+FifoQueue::Print ()
+{
+    ready.Mapcar ((VoidFunctionPtr) ThreadPrint);
+}
+
+//----------------------------------------------------------------------
+// PriorityQueue
+//      The ready threads, by priority, then in the order they became
+//      ready.
+//----------------------------------------------------------------------
+
+PriorityQueue::PriorityQueue ()
+{
+    numReady = 0;
+}
+
+void
+PriorityQueue::Put (Thread * thread)
+{
+    ready[thread->priority].Append (thread);
+    numReady++;
+}
+
+Thread *
+PriorityQueue::Get ()
+{
+    for (int p = NumPriorities - 1; p >= 0; p--)
+	if (!ready[p].IsEmpty ())
+	  {
+	      numReady--;
+	      return ready[p].Remove ();
+	  }
+    return NULL;
+}
+
+int
+PriorityQueue::NumReady ()
+{
+    return numReady;
+}
+
+void
+PriorityQueue::Print ()
+{
+    for (int p = NumPriorities - 1; p >= 0; p--)
+	if (!ready[p].IsEmpty ())
+	  {
+	      printf ("priority %d: ", p);
+	      ready[p].Mapcar ((VoidFunctionPtr) ThreadPrint);
+	      printf ("\n");
+	  }
+}
+
+//----------------------------------------------------------------------
+// MlfqQueue::MlfqQueue
+//      Initialize the queues of a multilevel feedback queue, empty.
+//----------------------------------------------------------------------
+
+MlfqQueue::MlfqQueue ()
+{
+    numReady = 0;
+    epoch = 0;
+    lastBoost = 0;
+}
+
+//----------------------------------------------------------------------
+// MlfqQueue::Reset
+//      Move "thread" to queue "level", with a full quantum for that
+//      level: 2^level timer interrupts.  Does not requeue it.
+//----------------------------------------------------------------------
+
+void
+MlfqQueue::Reset (Thread * thread, int level)
+{
+    thread->mlfqLevel = level;
+    thread->quantumLeft = 1 << level;
+    thread->mlfqEpoch = epoch;
+}
+
+//----------------------------------------------------------------------
+// MlfqQueue::Put
+//      Put "thread" at the end of the queue of its level.  A thread
+//      that missed a boost while it was blocked goes to the top queue.
+//----------------------------------------------------------------------
+
+void
+MlfqQueue::Put (Thread * thread)
+{
+    if (thread->mlfqEpoch != epoch)
+	Reset (thread, 0);
+    ready[thread->mlfqLevel].Append (thread);
+    numReady++;
+}
+
+//----------------------------------------------------------------------
+// MlfqQueue::Get
+//      Take the first thread of the highest non-empty queue.
+//----------------------------------------------------------------------
+
+Thread *
+MlfqQueue::Get ()
+{
+    for (int l = 0; l < NumMlfqLevels; l++)
+	if (!ready[l].IsEmpty ())
+	  {
+	      numReady--;
+	      return ready[l].Remove ();
+	  }
+    return NULL;
+}
+
+int
+MlfqQueue::NumReady ()
+{
+    return numReady;
+}
+
+void
+MlfqQueue::Print ()
+{
+    for (int l = 0; l < NumMlfqLevels; l++)
+	if (!ready[l].IsEmpty ())
+	  {
+	      printf ("level %d: ", l);
+	      ready[l].Mapcar ((VoidFunctionPtr) ThreadPrint);
+	      printf ("\n");
+	  }
+}
+
+//----------------------------------------------------------------------
+// MlfqQueue::Boost
+//      Put every ready thread back in the top queue, with a full
+//      quantum.  Threads that are blocked are moved when they become
+//      ready again (see Put), thanks to the new epoch.
+//----------------------------------------------------------------------
+
+void
+MlfqQueue::Boost ()
+{
+    Thread *thread;
+
+    DEBUG ('t', "MLFQ boost at time %lld\n", stats->totalTicks);
+    epoch++;
+    lastBoost = stats->totalTicks;
+    for (int l = 1; l < NumMlfqLevels; l++)
+	while ((thread = ready[l].Remove ()) != NULL)
+	  {
+	      Reset (thread, 0);
+	      ready[0].Append (thread);
+	  }
+}
+
+//----------------------------------------------------------------------
+// MlfqQueue::Tick
+//      The timer interrupted "running": charge it one tick of its
+//      quantum.  Once the quantum is used up, the thread moves down
+//      one queue and yields the CPU.  It also yields if a thread of a
+//      higher queue is ready.
+//----------------------------------------------------------------------
+
+bool
+MlfqQueue::Tick (Thread * running)
+{
+    if (stats->totalTicks - lastBoost >= MlfqBoostPeriod)
+	Boost ();
+    if (running->mlfqEpoch != epoch)
+	Reset (running, 0);
+
+    if (--running->quantumLeft <= 0)
+      {
+	  int level = running->mlfqLevel;
+
+	  if (level < NumMlfqLevels - 1)
+	      level++;
+	  DEBUG ('t', "Thread \"%s\" used up its quantum, now at level %d\n",
+		 running->getName (), level);
+	  Reset (running, level);
+	  return TRUE;
+      }
+    for (int l = 0; l < running->mlfqLevel; l++)
+	if (!ready[l].IsEmpty ())
+	    return TRUE;
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// MlfqQueue::IoWait
+//      "thread" is about to wait for the console or the disk: it is
+//      interactive, or at least not compute-bound, so it goes back to
+//      the top queue.
+//----------------------------------------------------------------------
+
+void
+MlfqQueue::IoWait (Thread * thread)
+{
+    Reset (thread, 0);
+}
+
+//----------------------------------------------------------------------
+// EdfQueue
+//      The ready real-time threads, by deadline.  Among equal deadlines,
+//      the thread that became ready first goes first.
+//----------------------------------------------------------------------
+
+void
+EdfQueue::Put (Thread * thread)
+{
+    ready.Append (thread);
+}
+
+Thread *
+EdfQueue::Earliest ()
+{
+    Thread *earliest = ready.First ();
+
+    for (Thread * t = earliest; t != NULL; t = t->listLink.next->item)
+	if (t->rtDeadline < earliest->rtDeadline)
+	    earliest = t;
+    return earliest;
+}
+
+Thread *
+EdfQueue::Get ()
+{
+    Thread *thread = Earliest ();
+
+    if (thread != NULL)
+	ready.Unlink (thread);
+    return thread;
+}
+
+int
+EdfQueue::NumReady ()
+{
+    return ready.NumItems ();
+}
+
+void
+EdfQueue::Print ()
+{
+    for (Thread * t = ready.First (); t != NULL; t = t->listLink.next->item)
+	printf ("%s (deadline %lld), ", t->getName (), t->rtDeadline);
+}
+
+long long
+EdfQueue::FirstDeadline ()
+{
+    Thread *thread = Earliest ();
+
+    return (thread != NULL) ? thread->rtDeadline : -1;
+}
@@ -0,0 +1,156 @@
+// policy.h
+//      Scheduling policies: how the ready threads are ordered.
+//
+//      The scheduler keeps its ready threads in a ReadyQueue.  The
+//      queue decides which of its threads runs next, and whether the
+//      running thread is preempted when the timer interrupts.  Three
+//      policies are provided ("nachos -sched <policy>"):
+//
+//      fifo -- the original Nachos scheduler: threads run in the order
+//              they became ready, and each timer interrupt is a time
+//              slice.
+//
+//      prio -- static priorities: the ready thread with the highest
+//              priority runs, FIFO among equals.  A thread inherits
+//              the priority of its creator; user programs change
+//              theirs with the SetPriority system call.
+//
+//      mlfq -- multilevel feedback queue.  A thread starts in the top
+//              queue; if it uses up its quantum, it moves down one
+//              queue, where the quantum is twice as long.  A thread
+//              that waits for the console or the disk goes back to
+//              the top queue, so that interactive programs are not
+//              starved by compute-bound ones.  Every MlfqBoostPeriod
+//              ticks, all threads go back to the top queue, so that
+//              compute-bound ones are not starved either.
+//
+//      Above the policy, real-time threads (see Scheduler::SetRealTime)
+//      have a queue of their own, ordered by deadline
+//      (EdfQueue), which always goes first.
+//
+//      The queues only hold ready threads: all the scheduling state of
+//      a thread is kept in the thread itself (see thread.h).
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef POLICY_H
+#define POLICY_H
+
+#include "copyright.h"
+#include "ilist.h"
+#include "thread.h"
+
+// Scheduling policies, as selected by "-sched"
+enum SchedulingPolicy { SchedFifo, SchedPriority, SchedMlfq };
+
+#define NumPriorities	8	// static priorities are 0 (lowest) to 7
+#define DefaultPriority	4	// priority of the main thread
+
+#define NumMlfqLevels	4	// MLFQ queues, 0 being the top one
+#define MlfqBoostPeriod	(50 * TimerTicks)	// every so often, all
+				// threads go back to the top queue
+
+// The following class defines the interface of a scheduling policy:
+// a queue of ready threads.
+
+class ReadyQueue
+{
+  public:
+    virtual ~ReadyQueue () {}
+
+    virtual void Put (Thread * thread) = 0;	// Thread is ready to run
+    virtual Thread *Get () = 0;	// Take the next thread to run off the
+    // queue, NULL if none
+    virtual int NumReady () = 0;	// Threads in the queue
+    virtual void Print () = 0;	// Print the threads in the queue
+
+    virtual bool Tick (Thread * running);	// The timer interrupted
+    // "running"; should it yield the CPU?
+    virtual void IoWait (Thread * thread);	// "thread" is going to wait
+    // for a device (console or disk)
+};
+
+extern ReadyQueue *NewReadyQueue (SchedulingPolicy policy);
+				// Create a queue following "policy"
+
+// The original FIFO scheduler.
+
+class FifoQueue:public ReadyQueue
+{
+  public:
+    void Put (Thread * thread);
+    Thread *Get ();
+    int NumReady ();
+    void Print ();
+
+  private:
+    IntrusiveList<Thread> ready;
+};
+
+// Static priorities.
+
+class PriorityQueue:public ReadyQueue
+{
+  public:
+    PriorityQueue ();
+
+    void Put (Thread * thread);
+    Thread *Get ();
+    int NumReady ();
+    void Print ();
+
+  private:
+    IntrusiveList<Thread> ready[NumPriorities];	// one queue per priority
+    int numReady;
+};
+
+// Multilevel feedback queue.
+
+class MlfqQueue:public ReadyQueue
+{
+  public:
+    MlfqQueue ();
+
+    void Put (Thread * thread);
+    Thread *Get ();
+    int NumReady ();
+    void Print ();
+
+    bool Tick (Thread * running);
+    void IoWait (Thread * thread);
+
+  private:
+    IntrusiveList<Thread> ready[NumMlfqLevels];	// one queue per level
+    int numReady;
+    int epoch;			// number of boosts so far
+    long long lastBoost;	// time of the last boost
+
+    void Boost ();		// put every thread back in the top queue
+    void Reset (Thread * thread, int level);	// move "thread" to
+    // "level", with a full quantum
+};
+
+// Real-time threads, earliest deadline first.  There are few of
+// them, so the queue is not sorted: Get looks for the earliest
+// deadline.
+
+class EdfQueue:public ReadyQueue
+{
+  public:
+    void Put (Thread * thread);
+    Thread *Get ();
+    int NumReady ();
+    void Print ();
+
+    long long FirstDeadline ();	// Earliest deadline in the queue,
+    // -1 if the queue is empty
+
+  private:
+    IntrusiveList<Thread> ready;
+
+    Thread *Earliest ();	// ready thread with the earliest deadline
+};
+
+#endif // POLICY_H
@@ -11,8 +11,9 @@
 //      end up calling FindNextToRun(), and that would put us in an 
 //      infinite loop.
 //
-//      Very simple implementation -- no priorities, straight FIFO.
-//      Might need to be improved in later assignments.
+//      The ready threads are ordered by the scheduling policy
+//      (policy.cc).  Real-time threads have a queue of their own,
+//      which goes first.
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -24,22 +25,28 @@
 
 //----------------------------------------------------------------------
 // Scheduler::Scheduler
-//      Initialize the list of ready but not running threads to empty.
+//      Initialize the lists of ready but not running threads to empty.
+//
+//      "policy" is the scheduling policy.
 //----------------------------------------------------------------------
 
-Scheduler::Scheduler ()
+Scheduler::Scheduler (SchedulingPolicy policy)
 {
-    readyList = new List;
+    readyQueue = NewReadyQueue (policy);
+    rtQueue = new EdfQueue ();
+    lastSwitch = 0;
+    rtLoad = 0;
 }
 
 //----------------------------------------------------------------------
 // Scheduler::~Scheduler
-//      De-allocate the list of ready threads.
+//      De-allocate the lists of ready threads.
 //----------------------------------------------------------------------
 
 Scheduler::~Scheduler ()
 {
-    delete readyList;
+    delete readyQueue;
+    delete rtQueue;
 }
 
 //----------------------------------------------------------------------
@@ -47,22 +54,53 @@ Scheduler::~Scheduler ()
 //      Mark a thread as ready, but not running.
 //      Put it on the ready list, for later scheduling onto the CPU.
 //
+//      A real-time thread that was blocked starts a new job, and
+//      preempts the current thread if it should run first.
+//
 //      "thread" is the thread to be put on the ready list.
 //----------------------------------------------------------------------
 
 void
 Scheduler::ReadyToRun (Thread * thread)
 {
+    bool wasBlocked = thread->getStatus () != RUNNING;
+
     DEBUG ('t', "Putting thread %s on ready list.\n", thread->getName ());
 
     thread->setStatus (READY);
-    readyList->Append ((void *) thread);
+    if (thread->rtPeriod > 0 && wasBlocked)
+	ReleaseJob (thread);
+    if (IsRealTime (thread))
+      {
+	  rtQueue->Put (thread);
+	  if (thread != currentThread
+	      && currentThread->getStatus () == RUNNING
+	      && Preempts (thread, currentThread))
+	      interrupt->YieldSoon ();
+      }
+    else
+	readyQueue->Put (thread);
+    if (timer != NULL)		// time slices are useful again
+	timer->Start ();
+}
+
+//----------------------------------------------------------------------
+// Scheduler::NumReady
+//      Return the number of threads ready to run.
+//----------------------------------------------------------------------
+
+int
+Scheduler::NumReady ()
+{
+    return readyQueue->NumReady () + rtQueue->NumReady ();
 }
 
 //----------------------------------------------------------------------
 // Scheduler::FindNextToRun
 //      Return the next thread to be scheduled onto the CPU.
 //      If there are no ready threads, return NULL.
+//
+//      Real-time threads go first.
 // Side effect:
 //      Thread is removed from the ready list.
 //----------------------------------------------------------------------
@@ -70,7 +108,9 @@ Scheduler::ReadyToRun (Thread * thread)
 Thread *
 Scheduler::FindNextToRun ()
 {
-    return (Thread *) readyList->Remove ();
+    if (rtQueue->NumReady () > 0)
+	return rtQueue->Get ();
+    return readyQueue->Get ();
 }
 
 //----------------------------------------------------------------------
@@ -100,13 +140,18 @@ Scheduler::Run (Thread * nextThread)
     if (currentThread->space != NULL)
       {				// if this thread is a user program,
 	  currentThread->SaveUserState ();	// save the user's CPU registers
-	  currentThread->space->SaveState ();
+	  currentThread->space->SaveState ();	// (lazily, see thread.cc)
       }
 #endif
 
     oldThread->CheckOverflow ();	// check if the old thread
     // had an undetected stack overflow
 
+    oldThread->runTicks += stats->totalTicks - lastSwitch;
+    oldThread->rtUsed += stats->totalTicks - lastSwitch;
+    lastSwitch = stats->totalTicks;
+    stats->numContextSwitches++;
+
     currentThread = nextThread;	// switch to the next thread
     currentThread->setStatus (RUNNING);	// nextThread is now running
 
@@ -135,8 +180,8 @@ Scheduler::Run (Thread * nextThread)
 #ifdef USER_PROGRAM
     if (currentThread->space != NULL)
       {				// if there is an address space
-	  currentThread->RestoreUserState ();	// to restore, do it.
-	  currentThread->space->RestoreState ();
+	  currentThread->RestoreUserState ();	// to restore, do it,
+	  currentThread->space->RestoreState ();	// unless still loaded
       }
 #endif
 }
@@ -150,5 +195,202 @@ void
 Scheduler::Print ()
 {
     printf ("Ready list contents:\n");
-    readyList->Mapcar ((VoidFunctionPtr) ThreadPrint);
+    readyQueue->Print ();
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Tick
+//      Called by the timer interrupt handler.  Return TRUE if the
+//      current thread should yield the CPU (when the handler returns).
+//
+//      A real-time thread yields if its job used up its budget (it is
+//      then demoted to its normal class), or if a job with an earlier
+//      deadline is ready; it has no time slice otherwise.  Any other
+//      thread yields if a real-time thread is ready, or else as
+//      decided by the policy.
+//----------------------------------------------------------------------
+
+bool
+Scheduler::Tick ()
+{
+    Thread *running = currentThread;
+    long long first = rtQueue->FirstDeadline ();
+
+    if (IsRealTime (running))
+      {
+	  CheckDeadline (running);
+	  if (running->rtUsed + stats->totalTicks - lastSwitch
+	      >= running->rtBudget)
+	    {
+		DEBUG ('t', "Thread \"%s\" used up its budget of %d ticks\n",
+		       running->getName (), running->rtBudget);
+		running->rtThrottled = TRUE;
+		stats->numBudgetOverruns++;
+		if (running->rtSlot >= 0)
+		    stats->rtThreads[running->rtSlot].overruns++;
+		return TRUE;
+	    }
+	  return first >= 0 && first < running->rtDeadline;
+      }
+    if (first >= 0)
+	return TRUE;
+    return readyQueue->Tick (running);
+}
+
+//----------------------------------------------------------------------
+// Scheduler::IoWait
+//      Let the policy know that "thread", which is running, is going
+//      to wait for the console or the disk.
+//----------------------------------------------------------------------
+
+void
+Scheduler::IoWait (Thread * thread)
+{
+    readyQueue->IoWait (thread);
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Blocked
+//      "thread", which is running, is going to sleep.  If it is a
+//      real-time thread, its job is done.
+//----------------------------------------------------------------------
+
+void
+Scheduler::Blocked (Thread * thread)
+{
+    if (thread->rtPeriod > 0)
+	EndJob (thread);
+}
+
+//----------------------------------------------------------------------
+// Scheduler::SetRealTime
+//      Move "thread", which must be running or blocked, into the
+//      real-time class: from now on, it should run "budget" ticks in
+//      every "period" ticks.  The thread starts a job at once.  With a
+//      "period" of 0, move it back to its normal class.
+//
+//      The real-time threads may reserve at most the whole time of the
+//      CPU.  Start the timer if there is none,
+//      to enforce the budgets.
+//
+//      Return FALSE, and change nothing, if the budget is not between
+//      1 and the period, or if there is not enough CPU time left.
+//----------------------------------------------------------------------
+
+bool
+Scheduler::SetRealTime (Thread * thread, int period, int budget)
+{
+    int oldLoad = 0, load = 0;
+
+    ASSERT (thread->getStatus () != READY);
+    if (period < 0)
+	return FALSE;
+    if (period > 0)
+      {
+	  if (budget <= 0 || budget > period)
+	      return FALSE;
+	  load = (int) divRoundUp (1000LL * budget, period);
+      }
+    if (thread->rtPeriod > 0)
+	oldLoad = (int) divRoundUp (1000LL * thread->rtBudget,
+				    thread->rtPeriod);
+    if (rtLoad - oldLoad + load > 1000)
+	return FALSE;
+    rtLoad += load - oldLoad;
+
+    DEBUG ('t', "Thread \"%s\" real-time period %d, budget %d\n",
+	   thread->getName (), period, budget);
+    if (thread->rtPeriod > 0)
+	EndJob (thread);
+    thread->rtPeriod = period;
+    thread->rtBudget = budget;
+    if (period == 0)
+	return TRUE;
+
+    if (thread->rtSlot < 0)
+	thread->rtSlot = stats->NewRtThread (thread->getName (), period,
+					     budget);
+    else
+      {
+	  stats->rtThreads[thread->rtSlot].period = period;
+	  stats->rtThreads[thread->rtSlot].budget = budget;
+      }
+    ReleaseJob (thread);
+    StartTimer ();
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Preempts
+//      Return TRUE if "thread" should run before "running": it is a
+//      real-time thread, and "running" is not, or has a later deadline.
+//----------------------------------------------------------------------
+
+bool
+Scheduler::Preempts (Thread * thread, Thread * running)
+{
+    return IsRealTime (thread) && (!IsRealTime (running)
+				   || thread->rtDeadline < running->rtDeadline);
+}
+
+//----------------------------------------------------------------------
+// Scheduler::ReleaseJob
+//      Start a new job for the real-time thread "thread", due one
+//      period from now, with a full budget.
+//----------------------------------------------------------------------
+
+void
+Scheduler::ReleaseJob (Thread * thread)
+{
+    thread->rtDeadline = stats->totalTicks + thread->rtPeriod;
+    thread->rtUsed = 0;
+    if (thread == currentThread)	// Run will charge it from the last
+	thread->rtUsed = lastSwitch - stats->totalTicks;	// switch on
+    thread->rtThrottled = FALSE;
+    thread->rtMissed = FALSE;
+    stats->numRtJobs++;
+    if (thread->rtSlot >= 0)
+	stats->rtThreads[thread->rtSlot].jobs++;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::EndJob
+//      The current job of the real-time thread "thread", if any, is
+//      done: check whether it was late.  The thread has no job until
+//      it becomes ready again.
+//----------------------------------------------------------------------
+
+void
+Scheduler::EndJob (Thread * thread)
+{
+    long long lateness = stats->totalTicks - thread->rtDeadline;
+
+    if (thread->rtDeadline < 0)
+	return;			// no job
+    CheckDeadline (thread);
+    if (thread->rtSlot >= 0
+	&& lateness > stats->rtThreads[thread->rtSlot].maxLateness)
+	stats->rtThreads[thread->rtSlot].maxLateness = lateness;
+    thread->rtDeadline = -1;
+    thread->rtThrottled = FALSE;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::CheckDeadline
+//      Count a deadline miss if the current job of the real-time
+//      thread "thread" is not done and past its deadline, once per job.
+//----------------------------------------------------------------------
+
+void
+Scheduler::CheckDeadline (Thread * thread)
+{
+    if (thread->rtDeadline < 0 || thread->rtMissed
+	|| stats->totalTicks <= thread->rtDeadline)
+	return;
+    DEBUG ('t', "Thread \"%s\" missed its deadline %lld\n",
+	   thread->getName (), thread->rtDeadline);
+    thread->rtMissed = TRUE;
+    stats->numDeadlineMisses++;
+    if (thread->rtSlot >= 0)
+	stats->rtThreads[thread->rtSlot].misses++;
 }
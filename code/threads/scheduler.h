@@ -10,17 +10,33 @@
 #define SCHEDULER_H
 
 #include "copyright.h"
-#include "list.h"
 #include "thread.h"
+#include "policy.h"
 
 // The following class defines the scheduler/dispatcher abstraction -- 
 // the data structures and operations needed to keep track of which 
 // thread is running, and which threads are ready but not running.
 
+//
+// The order of the ready threads, and the time slices, are up to the
+// scheduling policy ("-sched", see policy.h).  With the "fifo" policy,
+// this is the original Nachos scheduler.
+//
+// Whatever the policy, a thread can also join the real-time class
+// (SetRealTime), with a period and a budget.  Each time it becomes
+// ready after blocking, it releases a "job", due one period later,
+// which may run for at most its budget.  Real-time threads run before
+// all the others, earliest deadline first, and preempt the running
+// thread as soon as they become ready, instead of waiting for the
+// next timer interrupt.  A job that uses up its budget runs on in the
+// thread's normal class until it blocks.  Budgets are enforced at
+// timer interrupts, so they are only as precise as TimerTicks.
+
 class Scheduler
 {
   public:
-    Scheduler ();		// Initialize list of ready threads 
+    Scheduler (SchedulingPolicy policy = SchedFifo);
+    // Initialize list of ready threads
     ~Scheduler ();		// De-allocate ready list
 
     void ReadyToRun (Thread * thread);	// Thread can be dispatched.
@@ -28,10 +44,32 @@ class Scheduler
     // list, if any, and return thread.
     void Run (Thread * nextThread);	// Cause nextThread to start running
     void Print ();		// Print contents of ready list
+    int NumReady ();		// Number of threads ready
+    bool Tick ();		// The timer interrupted the current
+    // thread; should it yield the CPU?
+    void IoWait (Thread * thread);	// "thread" is going to wait for
+    // a device
+    bool SetRealTime (Thread * thread, int period, int budget);
+    // Move "thread" in or out of the real-time class
+    void Blocked (Thread * thread);	// "thread" is going to sleep
 
   private:
-      List * readyList;		// queue of threads that are ready to run,
-    // but not running
+    ReadyQueue * readyQueue;	// queue of threads that are ready to
+    // run, but not running
+    long long lastSwitch;	// time the current thread was dispatched
+    EdfQueue *rtQueue;		// ready real-time threads
+    int rtLoad;			// CPU share reserved by the real-time
+    // threads, in thousandths of a CPU
+
+    bool IsRealTime (Thread * thread)	// Does "thread" run in the
+    {				// real-time class right now?
+	return thread->rtPeriod > 0 && !thread->rtThrottled;
+    }
+    bool Preempts (Thread * thread, Thread * running);	// Should
+    // "thread" run before "running"?
+    void ReleaseJob (Thread * thread);	// Start a new real-time job
+    void EndJob (Thread * thread);	// The job of "thread" is done
+    void CheckDeadline (Thread * thread);	// Count a missed deadline
 };
 
 #endif // SCHEDULER_H
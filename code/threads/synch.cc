@@ -37,7 +37,6 @@ Semaphore::Semaphore (const char *debugName, int initialValue)
 {
     name = debugName;
     value = initialValue;
-    queue = new List;
 }
 
 //----------------------------------------------------------------------
@@ -48,7 +47,6 @@ Semaphore::Semaphore (const char *debugName, int initialValue)
 
 Semaphore::~Semaphore ()
 {
-    delete queue;
 }
 
 //----------------------------------------------------------------------
@@ -68,7 +66,7 @@ Semaphore::P ()
 
     while (value == 0)
       {				// semaphore not available
-	  queue->Append ((void *) currentThread);	// so go to sleep
+	  queue.Append (currentThread);	// so go to sleep
 	  currentThread->Sleep ();
       }
     value--;			// semaphore available,
@@ -77,6 +75,38 @@ Semaphore::P ()
     (void) interrupt->SetLevel (oldLevel);	// re-enable interrupts
 }
 
+//----------------------------------------------------------------------
+// Semaphore::P
+//      Like P(), but give up if the value did not become > 0 within
+//      "timeout" ticks.  The wait is ended by an alarm interrupt (see
+//      Thread::SleepFor): nothing polls.
+//
+//      Return TRUE if the value was decremented, FALSE on timeout.
+//----------------------------------------------------------------------
+
+bool
+Semaphore::P (long long timeout)
+{
+    IntStatus oldLevel = interrupt->SetLevel (IntOff);
+    long long deadline = stats->totalTicks + timeout;
+    bool acquired = TRUE;
+
+    while (value == 0)
+      {				// semaphore not available
+	  queue.Append (currentThread);	// so go to sleep, for the
+	  if (!currentThread->SleepFor (deadline - stats->totalTicks,
+					&queue))	// time left
+	    {
+		acquired = (value > 0);	// a V may have come just in time
+		break;
+	    }
+      }
+    if (acquired)
+	value--;
+    (void) interrupt->SetLevel (oldLevel);
+    return acquired;
+}
+
 //----------------------------------------------------------------------
 // Semaphore::V
 //      Increment semaphore value, waking up a waiter if necessary.
@@ -91,7 +121,7 @@ Semaphore::V ()
     Thread *thread;
     IntStatus oldLevel = interrupt->SetLevel (IntOff);
 
-    thread = (Thread *) queue->Remove ();
+    thread = queue.Remove ();
     if (thread != NULL)		// make thread ready, consuming the V immediately
 	scheduler->ReadyToRun (thread);
     value++;
@@ -129,45 +159,83 @@ Lock::Release ()
 Condition::Condition (const char *debugName)
 {
   name = debugName;
-  waitQueue = new List;
 }
 
 Condition::~Condition ()
 {
-  delete waitQueue;
 }
+
+//----------------------------------------------------------------------
+// Condition::Wait
+//      Release the lock and go to sleep, atomically, until signalled;
+//      then re-acquire the lock.  The thread itself goes on the wait
+//      queue: no semaphore is allocated for it.
+//----------------------------------------------------------------------
+
 void
 Condition::Wait (Lock * conditionLock)
 {
-  Semaphore *waiter;
+  IntStatus oldLevel = interrupt->SetLevel (IntOff);
 
 //  ASSERT(conditionLock->IsHeldByCurrentThread());
 
-  waiter = new Semaphore("condition", 0);
-  waitQueue->Append(waiter);
-  conditionLock->Release();
-  waiter->P();
-  conditionLock->Acquire();
-  delete waiter;
+  waitQueue.Append (currentThread);
+  conditionLock->Release ();
+  currentThread->Sleep ();
+  (void) interrupt->SetLevel (oldLevel);
+  conditionLock->Acquire ();
 }
 
+//----------------------------------------------------------------------
+// Condition::Wait
+//      Like Wait(), but wake up after "timeout" ticks if nobody
+//      signalled.  The lock is re-acquired in both cases.
+//
+//      Return TRUE if signalled, FALSE on timeout.
+//----------------------------------------------------------------------
+
+bool
+Condition::Wait (Lock * conditionLock, long long timeout)
+{
+  IntStatus oldLevel = interrupt->SetLevel (IntOff);
+  bool signalled;
+
+  waitQueue.Append (currentThread);
+  conditionLock->Release ();
+  signalled = currentThread->SleepFor (timeout, &waitQueue);
+  (void) interrupt->SetLevel (oldLevel);
+  conditionLock->Acquire ();
+  return signalled;
+}
+
+//----------------------------------------------------------------------
+// Condition::Signal
+//      Wake up the thread waiting the longest, if any.
+//----------------------------------------------------------------------
+
 void
 Condition::Signal (Lock * conditionLock)
 {
-  Semaphore *waiter;
+  Thread *thread;
+  IntStatus oldLevel = interrupt->SetLevel (IntOff);
 
   // ASSERT(conditionLock->IsHeldByCurrentThread());
 
-   if (!waitQueue->IsEmpty()) {
-       waiter = (Semaphore *) waitQueue->Remove();
- waiter->V();
-  }
+  thread = waitQueue.Remove ();
+  if (thread != NULL)
+      scheduler->ReadyToRun (thread);
+  (void) interrupt->SetLevel (oldLevel);
 }
 
+//----------------------------------------------------------------------
+// Condition::Broadcast
+//      Wake up all the threads waiting.
+//----------------------------------------------------------------------
+
 void
 Condition::Broadcast (Lock * conditionLock)
 {
-  while (!waitQueue->IsEmpty()) {
+  while (!waitQueue.IsEmpty()) {
        Signal(conditionLock);
 }
 }
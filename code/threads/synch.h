@@ -19,13 +19,15 @@
 
 #include "copyright.h"
 #include "thread.h"
-#include "list.h"
+#include "ilist.h"
 
 // The following class defines a "semaphore" whose value is a non-negative
 // integer.  The semaphore has only two operations P() and V():
 //
 //      P() -- waits until value > 0, then decrement
 //
+//      P(timeout) -- the same, but gives up after "timeout" ticks
+//
 //      V() -- increment, waking up a thread waiting in P() if necessary
 //
 // Note that the interface does *not* allow a thread to read the value of
@@ -50,11 +52,13 @@ class Semaphore
 
     void P ();			// these are the only operations on a semaphore
     void V ();			// they are both *atomic*
+    bool P (long long timeout);	// P, or FALSE after "timeout" ticks
 
   private:
     const char *name;		// useful for debugging
     int value;			// semaphore value, always >= 0
-    List *queue;		// threads waiting in P() for the value to be > 0
+    IntrusiveList<Thread> queue;	// threads waiting in P() for the
+    // value to be > 0
 };
 
 // The following class defines a "lock".  A lock can be BUSY or FREE.
@@ -107,6 +111,9 @@ class Lock
 //
 //      Broadcast() -- wake up all threads waiting on the condition
 //
+// Wait() may also be given a timeout, after which the thread wakes up
+// even if nobody signalled (it still re-acquires the lock).
+//
 // All operations on a condition variable must be made while
 // the current thread has acquired a lock.  Indeed, all accesses
 // to a given condition variable must be protected by the same lock.
@@ -142,6 +149,9 @@ class Condition
     // condition variables; releasing the
     // lock and going to sleep are
     // *atomic* in Wait()
+    bool Wait (Lock * conditionLock, long long timeout);
+    // Wait, but at most "timeout" ticks:
+    // FALSE if nobody signalled meanwhile
     void Signal (Lock * conditionLock);	// conditionLock must be held by
     void Broadcast (Lock * conditionLock);	// the currentThread for all of
     // these operations
@@ -149,7 +159,7 @@ class Condition
   private:
     const char *name;
     // plus some other stuff you'll need to define
-    List *waitQueue;
+    IntrusiveList<Thread> waitQueue;	// threads waiting in Wait()
 
 };
 #endif // SYNCH_H
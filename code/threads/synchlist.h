@@ -1,18 +1,21 @@
-// synchlist.h 
+// synchlist.h
 //      Data structures for synchronized access to a list.
 //
-//      Implemented by surrounding the List abstraction
-//      with synchronization routines.
+//      Implemented by surrounding the IntrusiveList abstraction
+//      with synchronization routines.  The items carry their own
+//      links (see ilist.h), so that queueing them allocates nothing.
+//
+//      Everything is inline, since SynchList is a template.
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
-// All rights reserved.  See copyright.h for copyright notice and limitation 
+// All rights reserved.  See copyright.h for copyright notice and limitation
 // of liability and disclaimer of warranty provisions.
 
 #ifndef SYNCHLIST_H
 #define SYNCHLIST_H
 
 #include "copyright.h"
-#include "list.h"
+#include "ilist.h"
 #include "synch.h"
 
 // The following class defines a "synchronized list" -- a list for which:
@@ -21,23 +24,109 @@
 //      wait until the list has an element on it.
 //      2. One thread at a time can access list data structures
 
+template <class T>
 class SynchList
 {
   public:
     SynchList ();		// initialize a synchronized list
     ~SynchList ();		// de-allocate a synchronized list
 
-    void Append (void *item);	// append item to the end of the list,
+    void Append (T *item);	// append item to the end of the list,
     // and wake up any thread waiting in remove
-    void *Remove ();		// remove the first item from the front of
+    T *Remove ();		// remove the first item from the front of
     // the list, waiting if the list is empty
     // apply function to every item in the list
     void Mapcar (VoidFunctionPtr func);
 
   private:
-      List * list;		// the unsynchronized list
+    IntrusiveList<T> list;	// the unsynchronized list
     Lock *lock;			// enforce mutual exclusive access to the list
     Condition *listEmpty;	// wait in Remove if the list is empty
 };
 
+//----------------------------------------------------------------------
+// SynchList<T>::SynchList
+//      Allocate and initialize the data structures needed for a
+//      synchronized list, empty to start with.
+//      Elements can now be added to the list.
+//----------------------------------------------------------------------
+
+template <class T>
+SynchList<T>::SynchList ()
+{
+    lock = new Lock ("list lock");
+    listEmpty = new Condition ("list empty cond");
+}
+
+//----------------------------------------------------------------------
+// SynchList<T>::~SynchList
+//      De-allocate the data structures created for synchronizing a list.
+//----------------------------------------------------------------------
+
+template <class T>
+SynchList<T>::~SynchList ()
+{
+    delete lock;
+    delete listEmpty;
+}
+
+//----------------------------------------------------------------------
+// SynchList<T>::Append
+//      Append an "item" to the end of the list.  Wake up anyone
+//      waiting for an element to be appended.
+//
+//      "item" is the thing to put on the list; it must not be on
+//              another list.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+SynchList<T>::Append (T *item)
+{
+    lock->Acquire ();		// enforce mutual exclusive access to the list
+    list.Append (item);
+    listEmpty->Signal (lock);	// wake up a waiter, if any
+    lock->Release ();
+}
+
+//----------------------------------------------------------------------
+// SynchList<T>::Remove
+//      Remove an "item" from the beginning of the list.  Wait if
+//      the list is empty.
+// Returns:
+//      The removed item.
+//----------------------------------------------------------------------
+
+template <class T>
+T *
+SynchList<T>::Remove ()
+{
+    T *item;
+
+    lock->Acquire ();		// enforce mutual exclusion
+    while (list.IsEmpty ())
+	listEmpty->Wait (lock);	// wait until list isn't empty
+    item = list.Remove ();
+    ASSERT (item != NULL);
+    lock->Release ();
+    return item;
+}
+
+//----------------------------------------------------------------------
+// SynchList<T>::Mapcar
+//      Apply function to every item on the list.  Obey mutual exclusion
+//      constraints.
+//
+//      "func" is the procedure to be applied.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+SynchList<T>::Mapcar (VoidFunctionPtr func)
+{
+    lock->Acquire ();
+    list.Mapcar (func);
+    lock->Release ();
+}
+
 #endif // SYNCHLIST_H
@@ -31,6 +31,7 @@ SynchDisk *synchDisk;
 Machine *machine;       // user program memory and registers
 SynchConsole *synchconsole;     // synchronous console
 FrameProvider *frameprovider;
+Pager *pager;			// demand paging
 #endif
 
 
@@ -55,7 +56,13 @@ extern void Cleanup ();
 //      which is what we wanted to context switch), we set a flag
 //      so that once the interrupt handler is done, it will appear as
 //      if the interrupted thread called Yield at the point it is
-//      was interrupted.
+//      was interrupted.  The scheduling policy may decide that the
+//      thread keeps the CPU instead (see Scheduler::Tick).
+//
+//      If no thread is ready, a time slice is pointless: we stop the
+//      timer until a thread becomes ready (see Scheduler::ReadyToRun),
+//      so that a lone thread, or an idle machine, is not interrupted
+//      for nothing.
 //
 //      "dummy" is because every interrupt handler takes one argument,
 //              whether it needs it or not.
@@ -63,10 +70,25 @@ extern void Cleanup ();
 static void
 TimerInterruptHandler (int dummy)
 {
-    if (interrupt->getStatus () != IdleMode)
+    if (scheduler->NumReady () == 0)
+	timer->Stop ();
+    else if (interrupt->getStatus () != IdleMode && scheduler->Tick ())
 	interrupt->YieldOnReturn ();
 }
 
+//----------------------------------------------------------------------
+// StartTimer
+//      Create the timer, with regular time slices, if Nachos was
+//      started without one (see Initialize).  Real-time threads need
+//      it to enforce their budgets.
+//----------------------------------------------------------------------
+void
+StartTimer ()
+{
+    if (timer == NULL)
+	timer = new Timer (TimerInterruptHandler, 0, FALSE);
+}
+
 //----------------------------------------------------------------------
 // Initialize
 //      Initialize Nachos global data structures.  Interpret command
@@ -83,9 +105,15 @@ Initialize (int argc, char **argv)
     int argCount;
     const char *debugArgs = "";
     bool randomYield = FALSE;
+    SchedulingPolicy policy = SchedFifo;	// how to order ready threads
 
 #ifdef USER_PROGRAM
     bool debugUserProg = FALSE;	// single step user program
+    EngineType engine = DefaultEngine;	// how to execute user instructions
+    const char *profileFile = NULL;	// profile user programs, writing
+					// the call chains there
+    ReplacementPolicy replace = ReplaceFifo;	// which pages to evict
+    int numFrames = NumPhysPages;	// frames given to user programs
 #endif
 #ifdef FILESYS_NEEDED
     bool format = FALSE;	// format disk
@@ -116,9 +144,78 @@ Initialize (int argc, char **argv)
 		randomYield = TRUE;
 		argCount = 2;
 	    }
+	  else if (!strcmp (*argv, "-sched"))
+	    {
+		ASSERT (argc > 1);
+		if (!strcmp (*(argv + 1), "fifo"))
+		    policy = SchedFifo;
+		else if (!strcmp (*(argv + 1), "prio"))
+		    policy = SchedPriority;
+		else if (!strcmp (*(argv + 1), "mlfq"))
+		    policy = SchedMlfq;
+		else
+		  {
+		      fprintf (stderr, "Unknown scheduling policy %s\n",
+			       *(argv + 1));
+		      ASSERT (FALSE);
+		  }
+		argCount = 2;
+	    }
 #ifdef USER_PROGRAM
 	  if (!strcmp (*argv, "-s"))
 	      debugUserProg = TRUE;
+	  if (!strcmp (*argv, "-engine"))
+	    {
+		ASSERT (argc > 1);
+		if (!strcmp (*(argv + 1), "switch"))
+		    engine = SwitchEngine;
+		else if (!strcmp (*(argv + 1), "threaded"))
+		    engine = ThreadedEngine;
+		else if (!strcmp (*(argv + 1), "lockstep"))
+		    engine = LockstepEngine;
+		else if (!strcmp (*(argv + 1), "tiered"))
+		    engine = TieredEngine;
+		else
+		  {
+		      fprintf (stderr, "Unknown engine %s\n", *(argv + 1));
+		      ASSERT (FALSE);
+		  }
+		argCount = 2;
+	    }
+	  if (!strcmp (*argv, "-prof"))
+	    {
+		ASSERT (argc > 1);
+		profileFile = *(argv + 1);
+		argCount = 2;
+	    }
+	  if (!strcmp (*argv, "-replace"))
+	    {
+		ASSERT (argc > 1);
+		if (!strcmp (*(argv + 1), "fifo"))
+		    replace = ReplaceFifo;
+		else if (!strcmp (*(argv + 1), "clock"))
+		    replace = ReplaceClock;
+		else if (!strcmp (*(argv + 1), "second"))
+		    replace = ReplaceSecondChance;
+		else if (!strcmp (*(argv + 1), "wsclock"))
+		    replace = ReplaceWSClock;
+		else if (!strcmp (*(argv + 1), "lru"))
+		    replace = ReplaceLru;
+		else
+		  {
+		      fprintf (stderr, "Unknown replacement policy %s\n",
+			       *(argv + 1));
+		      ASSERT (FALSE);
+		  }
+		argCount = 2;
+	    }
+	  if (!strcmp (*argv, "-frames"))
+	    {
+		ASSERT (argc > 1);
+		numFrames = atoi (*(argv + 1));
+		ASSERT (numFrames > 0 && numFrames <= NumPhysPages);
+		argCount = 2;
+	    }
 #endif
 #ifdef FILESYS_NEEDED
 	  if (!strcmp (*argv, "-f"))
@@ -143,8 +240,9 @@ Initialize (int argc, char **argv)
     DebugInit (debugArgs);	// initialize DEBUG messages
     stats = new Statistics ();	// collect statistics
     interrupt = new Interrupt;	// start up interrupt handling
-    scheduler = new Scheduler ();	// initialize the ready queue
-    if (randomYield)		// start the timer (if needed)
+    scheduler = new Scheduler (policy);	// initialize the ready queue
+    if (randomYield || policy != SchedFifo)	// start the timer (if needed):
+	// time slices are random with -rs, regular otherwise
 	timer = new Timer (TimerInterruptHandler, 0, randomYield);
 
     threadToBeDestroyed = NULL;
@@ -160,8 +258,12 @@ Initialize (int argc, char **argv)
 
 #ifdef USER_PROGRAM
     machine = new Machine (debugUserProg);	// this must come first
+    machine->engine = engine;
+    if (profileFile != NULL)
+	machine->profiler = new Profiler (profileFile);
     synchconsole = new SynchConsole(NULL,NULL);
-    frameprovider = new FrameProvider((int)(MemorySize/PageSize));
+    frameprovider = new FrameProvider(numFrames);
+    frameprovider->StartZeroing();	// keeps a pool of zeroed frames
 
 #endif
 
@@ -173,6 +275,11 @@ Initialize (int argc, char **argv)
     fileSystem = new FileSystem (format);
 #endif
 
+#ifdef USER_PROGRAM
+    pager = new Pager (replace);	// after the file system, which holds
+    // the swap file
+#endif
+
 #ifdef NETWORK
     postOffice = new PostOffice (netname, rely, 10);
 #endif
@@ -194,6 +301,7 @@ Cleanup ()
     delete machine;
     delete synchconsole;
     delete frameprovider;
+    delete pager;
 #endif
 
 #ifdef FILESYS_NEEDED
@@ -23,6 +23,7 @@ extern void Initialize (int argc, char **argv);	// Initialization,
 						// called before anything else
 extern void Cleanup ();		// Cleanup, called when
 						// Nachos is done.
+extern void StartTimer ();	// Create the timer, if there is none
 
 extern Thread *currentThread;	// the thread holding the CPU
 extern Thread *threadToBeDestroyed;	// the thread that just finished
@@ -36,10 +37,12 @@ extern Timer *timer;		// the hardware alarm clock
 #include "frameprovider.h"
 #include "synchconsole.h"
 #include "machine.h"
+#include "pager.h"
 //#include "../userprog/frameprovider.h"
 extern Machine *machine;	// user program memory and registers
 extern SynchConsole* synchconsole;
 extern FrameProvider *frameprovider;
+extern Pager *pager;		// brings user pages in and out
 #endif
 
 #ifdef FILESYS_NEEDED		// FILESYS or FILESYS_STUB
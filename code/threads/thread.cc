@@ -38,9 +38,30 @@ Thread::Thread (const char *threadName)
     stackTop = NULL;
     stack = NULL;
     status = JUST_CREATED;
+    priority = (currentThread != NULL) ? currentThread->priority
+	: DefaultPriority;	// inherited from the creator
+    mlfqLevel = 0;
+    quantumLeft = 0;
+    mlfqEpoch = -1;		// gets a fresh quantum when first ready
+    runTicks = 0;
+    wakeup = NULL;
+    sleepQueue = NULL;
+    timedOut = FALSE;
+    rtPeriod = 0;
+    rtBudget = 0;
+    rtDeadline = -1;
+    rtUsed = 0;
+    rtThrottled = FALSE;
+    rtMissed = FALSE;
+    rtSlot = -1;
 
 #ifdef USER_PROGRAM
     space = NULL;
+    futexKey = -1;
+    profile.node = NULL;
+    profile.target = -1;
+    profile.call = FALSE;
+    profile.overflow = 0;
     // FBT: Need to initialize special registers of simulator to 0
     // in particular LoadReg or it could crash when switching
     // user threads.
@@ -64,15 +85,27 @@ Thread::Thread (const char *threadName)
 //      NOTE: if this is the main thread, we can't delete the stack
 //      because we didn't allocate it -- we got it automatically
 //      as part of starting up Nachos.
+//
+//      The time the thread ran goes into the statistics.
 //----------------------------------------------------------------------
 
 Thread::~Thread ()
 {
-    DEBUG ('t', "Deleting thread \"%s\"\n", name);
+    DEBUG ('t', "Deleting thread \"%s\", which ran for %lld ticks\n",
+	   name, runTicks);
 
     ASSERT (this != currentThread);
+    if (rtPeriod > 0)
+	scheduler->SetRealTime (this, 0, 0);	// give its share back
+    stats->numThreadsFinished++;
+    stats->threadTicks += runTicks;
+    if (runTicks > stats->maxThreadTicks)
+	stats->maxThreadTicks = runTicks;
     if (stack != NULL)
 	DeallocBoundedArray ((char *) stack, StackSize * sizeof (int));
+#ifdef USER_PROGRAM
+    ReleaseUserState ();
+#endif
 }
 
 //----------------------------------------------------------------------
@@ -187,7 +220,8 @@ Thread::Finish ()
 //      If so, put the thread on the end of the ready list, so that
 //      it will eventually be re-scheduled.
 //
-//      NOTE: returns immediately if no other thread on the ready queue.
+//      NOTE: returns immediately if no other thread on the ready queue
+//      (or if the scheduling policy prefers this thread to the others).
 //      Otherwise returns when the thread eventually works its way
 //      to the front of the ready list and gets re-scheduled.
 //
@@ -209,12 +243,12 @@ Thread::Yield ()
 
     DEBUG ('t', "Yielding thread \"%s\"\n", getName ());
 
-    nextThread = scheduler->FindNextToRun ();
-    if (nextThread != NULL)
-      {
-	  scheduler->ReadyToRun (this);
-	  scheduler->Run (nextThread);
-      }
+    scheduler->ReadyToRun (this);	// compete with the ready threads,
+    nextThread = scheduler->FindNextToRun ();	// so that the policy
+    if (nextThread != this)	// may keep us running
+	scheduler->Run (nextThread);
+    else
+	setStatus (RUNNING);
     (void) interrupt->SetLevel (oldLevel);
 }
 
@@ -248,12 +282,79 @@ Thread::Sleep ()
     DEBUG ('t', "Sleeping thread \"%s\"\n", getName ());
 
     status = BLOCKED;
+    scheduler->Blocked (this);
     while ((nextThread = scheduler->FindNextToRun ()) == NULL)
 	interrupt->Idle ();	// no one to run, wait for an interrupt
 
     scheduler->Run (nextThread);	// returns when we've been signalled
 }
 
+//----------------------------------------------------------------------
+// ThreadWakeUp
+//      Interrupt handler ending Thread::SleepFor, if nobody woke the
+//      thread up before: take it off the queue it waits on, and make
+//      it ready.  If it was woken up, but did not run yet, there is
+//      nothing to do.
+//
+//      "arg" is the sleeping thread.
+//----------------------------------------------------------------------
+
+static void
+ThreadWakeUp (int arg)
+{
+    Thread *thread = (Thread *) arg;
+
+    thread->wakeup = NULL;	// the interrupt is gone
+    if (thread->getStatus () != BLOCKED)
+	return;
+    DEBUG ('t', "Waking up thread \"%s\" at time %lld\n",
+	   thread->getName (), stats->totalTicks);
+    if (thread->sleepQueue != NULL)
+	thread->sleepQueue->Unlink (thread);
+    thread->timedOut = TRUE;
+    scheduler->ReadyToRun (thread);
+}
+
+//----------------------------------------------------------------------
+// Thread::SleepFor
+//      Like Sleep, but if nobody wakes us up within "ticks", an alarm
+//      interrupt does.  No thread polls for the time to be up, and if
+//      no thread is ready meanwhile, Interrupt::Idle jumps straight to
+//      the alarm.
+//
+//      "queue" is the queue we were put on, to wait for someone to
+//      wake us up (NULL if nobody can): the alarm takes us off it.
+//
+//      Return TRUE if we were woken up before the time was up, FALSE
+//      if the alarm woke us up.  Interrupts must be disabled, as for
+//      Sleep.
+//----------------------------------------------------------------------
+
+bool
+Thread::SleepFor (long long ticks, IntrusiveList<Thread> *queue)
+{
+    ASSERT (this == currentThread);
+    ASSERT (interrupt->getLevel () == IntOff);
+
+    if (ticks <= 0)
+      {				// time is already up
+	  if (queue != NULL)
+	      queue->Unlink (this);
+	  return FALSE;
+      }
+    sleepQueue = queue;
+    timedOut = FALSE;
+    wakeup = interrupt->Schedule (ThreadWakeUp, (int) this, ticks, AlarmInt);
+    Sleep ();
+    if (wakeup != NULL)
+      {				// the alarm is no longer needed
+	  interrupt->Cancel (wakeup);
+	  wakeup = NULL;
+      }
+    sleepQueue = NULL;
+    return !timedOut;
+}
+
 //----------------------------------------------------------------------
 // ThreadFinish, InterruptEnable, ThreadPrint
 //      Dummy functions because C++ does not allow a pointer to a member
@@ -383,6 +484,11 @@ Thread::StackAllocate (VoidFunctionPtr func, int arg)
 #ifdef USER_PROGRAM
 #include "machine.h"
 
+// The thread whose user registers are in the machine, if any.  They
+// stay there while kernel threads run, and are only copied out when
+// another user thread needs the machine.
+static Thread *userStateOwner = NULL;
+
 //----------------------------------------------------------------------
 // Thread::SaveUserState
 //      Save the CPU state of a user program on a context switch.
@@ -390,13 +496,16 @@ Thread::StackAllocate (VoidFunctionPtr func, int arg)
 //      Note that a user program thread has *two* sets of CPU registers --
 //      one for its state while executing user code, one for its state
 //      while executing kernel code.  This routine saves the former.
+//
+//      The registers are left in the machine, and only copied into
+//      userRegisters if another user thread is restored before this
+//      one runs again (see RestoreUserState).
 //----------------------------------------------------------------------
 
 void
 Thread::SaveUserState ()
 {
-    for (int i = 0; i < NumTotalRegs; i++)
-	userRegisters[i] = machine->ReadRegister (i);
+    userStateOwner = this;
 }
 
 //----------------------------------------------------------------------
@@ -406,13 +515,35 @@ Thread::SaveUserState ()
 //      Note that a user program thread has *two* sets of CPU registers --
 //      one for its state while executing user code, one for its state
 //      while executing kernel code.  This routine restores the former.
+//
+//      Nothing is copied if the machine still holds our registers,
+//      i.e. if only kernel threads ran since we were switched out.
 //----------------------------------------------------------------------
 
 void
 Thread::RestoreUserState ()
 {
+    if (userStateOwner == this)
+	return;
+    if (userStateOwner != NULL)	// evict the previous owner
+	for (int i = 0; i < NumTotalRegs; i++)
+	    userStateOwner->userRegisters[i] = machine->ReadRegister (i);
     for (int i = 0; i < NumTotalRegs; i++)
 	machine->WriteRegister (i, userRegisters[i]);
+    userStateOwner = this;
+}
+
+//----------------------------------------------------------------------
+// Thread::ReleaseUserState
+//      Forget that the machine holds our user registers, as we are
+//      going away.
+//----------------------------------------------------------------------
+
+void
+Thread::ReleaseUserState ()
+{
+    if (userStateOwner == this)
+	userStateOwner = NULL;
 }
 
 int
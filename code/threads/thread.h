@@ -39,13 +39,17 @@
 
 #include "copyright.h"
 #include "utility.h"
+#include "ilist.h"
 #include "../filesys/openfile.h"
 
 #define MAX 10
 
+class PendingInterrupt;
+
 #ifdef USER_PROGRAM
 #include "machine.h"
 #include "addrspace.h"
+#include "profile.h"
 #define NumTotalRegs    40
 #endif
 
@@ -102,6 +106,8 @@ class Thread
     // other thread is runnable
     void Sleep ();		// Put the thread to sleep and
     // relinquish the processor
+    bool SleepFor (long long ticks, IntrusiveList<Thread> *queue);
+    // Sleep, but at most "ticks"
     void Finish ();		// The thread is done executing
 
     void CheckOverflow ();	// Check if thread has
@@ -110,6 +116,10 @@ class Thread
     {
 	   status = st;
     }
+    ThreadStatus getStatus ()
+    {
+	   return status;
+    }
     const char *getName ()
     {
 	   return (name);
@@ -119,6 +129,33 @@ class Thread
 	   printf ("%s, ", name);
     }
 
+    ListLink<Thread> listLink;	// links the thread on the ready list, or
+    // on the queue of what it waits for
+
+    // scheduling state, used by the scheduling policies (see policy.h)
+    int priority;		// static priority
+    int mlfqLevel;		// MLFQ queue the thread belongs to
+    int quantumLeft;		// timer interrupts left in its MLFQ quantum
+    int mlfqEpoch;		// MLFQ boosts the thread has seen
+    long long runTicks;		// time the thread spent running so far
+    PendingInterrupt *wakeup;	// interrupt that will end SleepFor,
+    // NULL if none
+    IntrusiveList<Thread> *sleepQueue;	// queue the thread waits on
+    // in SleepFor, if any
+    bool timedOut;		// SleepFor was ended by the alarm
+
+    // real-time state (see Scheduler::SetRealTime)
+    int rtPeriod;		// period, 0 if not a real-time thread
+    int rtBudget;		// time it may run in each period
+    long long rtDeadline;	// deadline of its current job, -1 if
+    // it has none (it is blocked)
+    long long rtUsed;		// time its current job ran so far
+    bool rtThrottled;		// its job used up the budget, and runs
+    // in the normal class until it blocks
+    bool rtMissed;		// its job missed the deadline
+    int rtSlot;			// its counters in stats->rtThreads,
+    // -1 if none
+
     int openFileTable[MAX];
     int count_file;
     bool addFile(int sector);
@@ -149,8 +186,12 @@ class Thread
   public:
     void SaveUserState ();	// save user-level register state
     void RestoreUserState ();	// restore user-level register state
+    void ReleaseUserState ();	// the machine no longer holds them
 
     AddrSpace *space;		// User code this thread is running.
+    int futexKey;		// Virtual address of the user word it
+    // waits on, if in FutexWait (see futex.h)
+    ProfileCursor profile;	// Position in the profiler's call tree
 #endif
 };
 
@@ -18,7 +18,7 @@
 #include "copyright.h"
 #include "system.h"
 #include "addrspace.h"
-#include "noff.h"
+#include "syscall.h"
 #include <stdio.h>
 #include <strings.h>		/* for bzero */
 //#include "frameprovider.h"
@@ -49,41 +49,29 @@ SwapHeader (NoffHeader * noffH)
     noffH->uninitData.inFileAddr = WordToHost (noffH->uninitData.inFileAddr);
 }
 
-static void
-ReadAtVirtual( OpenFile *executable, int virtualaddr, int numBytes, int position, TranslationEntry *new_pageTable,
-                    unsigned new_numPages)
-{
-    /*Save of the former page_table*/
-    TranslationEntry* former_pageTable = machine->pageTable;
-    machine->pageTable = new_pageTable;
-
-    /*Save of the former numPages*/
-    unsigned int former_numPages = machine->pageTableSize;
-    machine->pageTableSize = new_numPages; //numPages = size
-
-    char save[numBytes];
-    /*Save inside the buffer*/
-    int verif;
-
-    if((verif = executable->ReadAt(save, numBytes, position) != numBytes))
-    {
-        fprintf(stderr, "%s", "Error when reading the memory\n");
-    }
-
-    /*Writing back into the memory*/
-    for (int i = 0; i < numBytes; i++)
-    {
-        if(machine->WriteMem(virtualaddr + i, sizeof(char), save[i]) != TRUE) //sizeof(char) = 1
-        {
-          fprintf(stderr, "%s", "Error when Writing in the meory\n");
-        }
-    }
+//----------------------------------------------------------------------
+// ReadSegment
+//      Read the part of segment "seg" of "executable" that lies in the
+//      virtual page starting at "pageAddr" into "page", the host copy
+//      of the frame holding it.  Return FALSE if there is none.
+//----------------------------------------------------------------------
 
-    machine->pageTable = former_pageTable;
-    machine->pageTableSize = former_numPages;
+static bool
+ReadSegment (OpenFile * executable, Segment * seg, int pageAddr, char *page)
+{
+    int from = seg->virtualAddr, to = seg->virtualAddr + seg->size;
+
+    if (from < pageAddr)
+	from = pageAddr;
+    if (to > pageAddr + PageSize)
+	to = pageAddr + PageSize;
+    if (from >= to)
+	return FALSE;
+    executable->ReadAt (page + from - pageAddr, to - from,
+			seg->inFileAddr + from - seg->virtualAddr);
+    return TRUE;
 }
 
-
 //----------------------------------------------------------------------
 // AddrSpace::AddrSpace
 //      Create an address space to run a user program.
@@ -96,13 +84,15 @@ ReadAtVirtual( OpenFile *executable, int virtualaddr, int numBytes, int position
 //      memory.  For now, this is really simple (1:1), since we are
 //      only uniprogramming, and we have a single unsegmented page table
 //
-//      "executable" is the file containing the object code to load into memory
+//      "executable" is the file containing the object code to load into memory.
+//      It is kept open to load the pages on demand, and closed with the
+//      address space.
 //----------------------------------------------------------------------
 
 AddrSpace::AddrSpace (OpenFile * executable)
 {
     NoffHeader noffH;
-    unsigned int i, size;
+    unsigned int size;
 
 
     executable->ReadAt ((char *) &noffH, sizeof (noffH), 0);
@@ -117,27 +107,91 @@ AddrSpace::AddrSpace (OpenFile * executable)
     numPages = divRoundUp (size, PageSize);
     size = numPages * PageSize;
 
-    ASSERT ((int)numPages <= frameprovider->NumAvailFrame());	// check we're not trying
-    // to run anything too big --
-    // at least until we have
-    // virtual memory
-
     DEBUG ('a', "Initializing address space, num pages %d, size %d\n",
 	   numPages, size);
 
+// no frame yet: the pages are brought in on demand (see vm/pager.cc)
+    InitPageTable ();
+    InitThreads ();
+
+// the code and data segments are read from the executable when their
+// pages are first touched, the other pages start zeroed (see LoadPage)
+    DEBUG ('a', "Code segment at 0x%x, size %d; data segment at 0x%x, "
+	   "size %d\n", noffH.code.virtualAddr, noffH.code.size,
+	   noffH.initData.virtualAddr, noffH.initData.size);
+    executableFile = executable;
+    executableUsers = new int (1);
+    executableId = executable->Identity ();
+    code = noffH.code;
+    initData = noffH.initData;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::AddrSpace
+//      Create a copy of the address space "parent", for Fork.  The
+//      frames of the parent are shared, read-only, and copied only when
+//      one of the two address spaces writes to them (see Pager::Fork).
+//      The executable is shared too.
+//
+//      "stackAddr" is the stack pointer of the thread calling Fork: its
+//      stack is taken in the copy as well.
+//----------------------------------------------------------------------
+
+AddrSpace::AddrSpace (AddrSpace * parent, int stackAddr)
+{
+    numPages = parent->numPages;
+    DEBUG ('a', "Copying address space, num pages %d\n", numPages);
+    InitPageTable ();
+    InitThreads ();
+    threadBitMap->Mark ((numPages * PageSize - stackAddr)
+			/ (threadPages * PageSize));
+    tidCount = parent->tidCount;	// the forking thread keeps its id
+
+    executableFile = parent->executableFile;
+    executableUsers = parent->executableUsers;
+    (*executableUsers)++;
+    executableId = parent->executableId;
+    code = parent->code;
+    initData = parent->initData;
+
+    pager->Fork (parent, this);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::InitPageTable
+//      Allocate the page table, all pages invalid.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::InitPageTable ()
+{
     pageTable = new TranslationEntry[numPages];
-    for (i = 0; i < numPages; i++)
+    swapSlot = new int[numPages];
+    copyOnWrite = new bool[numPages];
+    for (unsigned int i = 0; i < numPages; i++)
       {
-	  pageTable[i].virtualPage = i;	// for now, virtual page # = phys page #
-	  pageTable[i].physicalPage = frameprovider->GetEmptyFrame();
-	  pageTable[i].valid = TRUE;
+	  pageTable[i].virtualPage = i;
+	  pageTable[i].physicalPage = 0;
+	  pageTable[i].valid = FALSE;
 	  pageTable[i].use = FALSE;
 	  pageTable[i].dirty = FALSE;
 	  pageTable[i].readOnly = FALSE;	// if the code segment was entirely on
 	  // a separate page, we could set its
 	  // pages to be read-only
+	  swapSlot[i] = -1;
+	  copyOnWrite[i] = FALSE;
       }
+}
 
+//----------------------------------------------------------------------
+// AddrSpace::InitThreads
+//      Set up the bookkeeping of the user threads: only the main one
+//      so far.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::InitThreads ()
+{
       tidCount =0; // ID threads used for user join and returned at creation
       threadNumber = 1; //Number of active threads
       semThreadNumber = new Semaphore("semThreadNumber",1); //for mutual exclusion on threadNumber
@@ -153,50 +207,52 @@ AddrSpace::AddrSpace (OpenFile * executable)
       for(int ij=0;ij<lengthBitMap;ij++){ // semaphore table for join calls
         this->semThreadJoin[ij] = new Semaphore("semThreadJoin",0);
       }
+}
 
+//----------------------------------------------------------------------
+// AddrSpace::LoadPage
+//      Fill physical "frame" with the initial contents of virtual page
+//      "vpn": the parts of the code and data segments lying in that
+//      page, and zeroes elsewhere.  Called by the pager on the first
+//      fault on the page, with a frame already zeroed: a page of the
+//      stack or of the uninitialized data costs nothing more.
+//
+//      Return FALSE if the page only holds zeroes: nothing was read.
+//----------------------------------------------------------------------
 
-// zero out the entire address space, to zero the unitialized data segment
-// and the stack segment
-
-//    bzero (machine->mainMemory, size);
-
-// then, copy in the code and data segments into memory
-    if (noffH.code.size > 0)
-      {
-	  DEBUG ('a', "Initializing code segment, at 0x%x, size %d\n",
-		 noffH.code.virtualAddr, noffH.code.size);
-        #ifndef CHANGED
-	  executable->ReadAt (&(machine->mainMemory[noffH.code.virtualAddr]),
-			      noffH.code.size, noffH.code.inFileAddr);
-        #else
-        ReadAtVirtual(executable, noffH.code.virtualAddr, noffH.code.size, noffH.code.inFileAddr, pageTable, numPages);
-        #endif //CHANGED
-
-
-      }
-    if (noffH.initData.size > 0)
-      {
-	  DEBUG ('a', "Initializing data segment, at 0x%x, size %d\n",
-		 noffH.initData.virtualAddr, noffH.initData.size);
-     #ifndef CHANGED
-	  executable->ReadAt (&
-			      (machine->mainMemory
-			       [noffH.initData.virtualAddr]),
-			      noffH.initData.size, noffH.initData.inFileAddr);
-      #else
-        ReadAtVirtual(executable, noffH.initData.virtualAddr, noffH.initData.size, noffH.initData.inFileAddr, pageTable, numPages);
-      #endif //CHANGED
+bool
+AddrSpace::LoadPage (int vpn, int frame)
+{
+    char *page = &machine->mainMemory[frame * PageSize];
+    bool inCode, inData;
 
-      }
+    inCode = ReadSegment (executableFile, &code, vpn * PageSize, page);
+    inData = ReadSegment (executableFile, &initData, vpn * PageSize, page);
+    return inCode || inData;
+}
 
+//----------------------------------------------------------------------
+// AddrSpace::IsText
+//      Return TRUE if virtual page "vpn" lies wholly in the code
+//      segment.  Such a page is never written, and is the same in
+//      every address space running the program: the pager shares it
+//      between them, read-only.  The pages at the ends of the segment
+//      may hold data too, and are not shared.
+//----------------------------------------------------------------------
 
+bool
+AddrSpace::IsText (int vpn)
+{
+    int start = vpn * PageSize;
 
+    return code.size > 0 && start >= code.virtualAddr
+	&& start + PageSize <= code.virtualAddr + code.size;
 }
 
-
 //----------------------------------------------------------------------
 // AddrSpace::~AddrSpace
-//      Dealloate an address space.  Nothing for now!
+//      Dealloate an address space: give back its frames and swap
+//      slots, and close its executable.
 //----------------------------------------------------------------------
 
 AddrSpace::~AddrSpace ()
@@ -208,10 +264,20 @@ AddrSpace::~AddrSpace ()
   */// LB: Missing [] for delete
   // delete pageTable;
   // End of modification
-  for (int i = 0; i < (int)numPages; i++){
-   frameprovider->ReleaseFrame(pageTable[i].physicalPage);
-  }
+  pager->FreeSpace(this);
+  if (--(*executableUsers) == 0)
+    {				// no forked copy left
+      delete executableFile;
+      delete executableUsers;
+    }
+  if (machine->pageTable == pageTable)
+    {				// a new table could get the same address,
+	machine->pageTable = NULL;	// see RestoreState
+	machine->pageTableSize = 0;
+    }
    delete [] pageTable;
+   delete [] swapSlot;
+   delete [] copyOnWrite;
 }
 
 //----------------------------------------------------------------------
@@ -252,14 +318,22 @@ AddrSpace::InitRegisters ()
 //      On a context switch, save any machine state, specific
 //      to this address space, that needs saving.
 //
-//      For now, nothing!
+//      The machine's page table is left in place, so that RestoreState
+//      has nothing to do if we run next.  But a thread switched out in
+//      the middle of CompareAndSwap must start it over when it runs
+//      again (see test/start.S).
 //----------------------------------------------------------------------
 
 void
 AddrSpace::SaveState ()
 {
-  pageTable = machine->pageTable;
-  numPages = machine->pageTableSize;
+    int pc = machine->ReadRegister (PCReg);
+
+    if (pc > AtomicSeqBegin && pc < AtomicSeqEnd)
+      {
+	  machine->WriteRegister (PCReg, AtomicSeqBegin);
+	  machine->WriteRegister (NextPCReg, AtomicSeqBegin + 4);
+      }
 }
 
 //----------------------------------------------------------------------
@@ -267,14 +341,21 @@ AddrSpace::SaveState ()
 //      On a context switch, restore the machine state so that
 //      this address space can run.
 //
-//      For now, tell the machine where to find the page table.
+//      For now, tell the machine where to find the page table, and
+//      make it forget the block of code it was fetching from and the
+//      translations it cached for the previous page table.  Nothing
+//      to do if the page table is already ours.
 //----------------------------------------------------------------------
 
 void
 AddrSpace::RestoreState ()
 {
+    if (machine->pageTable == pageTable && machine->pageTableSize == numPages)
+	return;
     machine->pageTable = pageTable;
     machine->pageTableSize = numPages;
+    machine->ResetFetch ();
+    machine->FlushTranslationCache ();
 }
 
 
@@ -17,6 +17,7 @@
 #include "filesys.h"
 #include "synch.h"
 #include "bitmap.h"
+#include "noff.h"
 
 #define UserStackSize	2048	// increase this as necessary!
 #define threadPages 2
@@ -30,6 +31,8 @@ class AddrSpace
     AddrSpace (OpenFile * executable);	// Create an address space,
     // initializing it with the program
     // stored in the file "executable"
+    AddrSpace (AddrSpace * parent, int stackAddr);	// Create a
+    // copy-on-write copy of "parent"
     ~AddrSpace ();		// De-allocate an address space
 
     void InitRegisters ();	// Initialize user-level CPU registers,
@@ -60,11 +63,32 @@ class AddrSpace
     Semaphore* semThreadJoin[10];
 
     int getNumPages();
+
+    bool LoadPage (int vpn, int frame);	// Fill physical "frame" with the
+    // initial contents of virtual page "vpn"; FALSE if only zeroes
+    bool IsText (int vpn);	// Whether "vpn" only holds code, and can
+    // be shared with the other address spaces running the program
+
   private:
       TranslationEntry * pageTable;	// Assume linear page table translation
     // for now!
     unsigned int numPages;	// Number of pages in the virtual
     // address space
+    int *swapSlot;		// Where each page was written out in the
+    // swap space, -1 if it never was
+    bool *copyOnWrite;		// Which pages are read-only because
+    // their frame is shared with a forked address space
+
+    OpenFile *executableFile;	// The program, kept open to load its
+    Segment code, initData;	// pages on demand
+    int *executableUsers;	// Address spaces sharing executableFile
+    int executableId;		// Identity of the program (see
+    // OpenFile::Identity), for sharing its text pages
+
+    void InitPageTable ();	// Allocate the page table, all invalid
+    void InitThreads ();	// Set up the user thread bookkeeping
+
+    friend class Pager;		// Brings the pages in and out
 };
 
 #endif // ADDRSPACE_H
@@ -27,6 +27,7 @@
 #include "../machine/synchconsole.h"
 #include "userthread.h"
 #include "forkexec.h"
+#include "futex.h"
 
 extern void SynchPutChar(const char cr);
 extern SynchConsole *synchconsole;
@@ -45,25 +46,15 @@ UpdatePC ()
     machine->WriteRegister (NextPCReg, pc);
 }
 
+// Copy the string whose address is in register "from" into "to", of
+// "size" bytes (at most size - 1 characters, then a NUL).
 static void copyStringFromMachine(int from, char *to, unsigned int size){
-  unsigned int i; // counter
-  int cr; // character read
-  int addr; //address of the character to read
-  for(i=0;i<size;i++){
-    addr = (i+(machine->ReadRegister(from))); // get the address of the char
-    machine->ReadMem(addr, 1, &cr); // get the char
-    to[i] = (char) cr; // concat it
-  }
-  to[i]='\0';
+  machine->CopyStringFromUser(machine->ReadRegister(from), to, size);
 }
 
+// Copy "size" bytes of "from" to the address held in register "to".
 static void copyStringToMachine(int to, char *from, unsigned int size){
-  unsigned int i; // counter
-  int addr; //address of the character to read
-  for(i=0;i<size;i++){
-    addr = (i+(machine->ReadRegister(to))); // get the address of the char
-    machine->WriteMem(addr, 1, from[i]); // get the char
-  }
+  machine->CopyToUser(machine->ReadRegister(to), from, size);
 }
 //----------------------------------------------------------------------
 // ExceptionHandler
@@ -107,6 +98,22 @@ ExceptionHandler (ExceptionType which)
         }
 
     #else //CHANGED
+      if(which == PageFaultException){
+        int addr = machine->ReadRegister(BadVAddrReg);
+        if(!pager->PageFault(addr)){
+          printf ("Out of memory: cannot bring in the page at 0x%x\n", addr);
+          ASSERT (FALSE);
+        }
+        return; // the faulting instruction is run again
+      }
+      if(which == ReadOnlyException){
+        int addr = machine->ReadRegister(BadVAddrReg);
+        if(!pager->CopyOnWrite(addr)){
+          printf ("Write to the read-only page at 0x%x, or out of memory\n", addr);
+          ASSERT (FALSE);
+        }
+        return; // run again, on a page of its own
+      }
       if(which == SyscallException){
         switch(type){
           case SC_Halt:{
@@ -153,12 +160,17 @@ ExceptionHandler (ExceptionType which)
             break;
           }
           case SC_SynchGetInt:{
-            char *stg = new char[10];
+            char *stg = new char[11];
             int i=0;
             synchconsole->SynchGetString(stg , 11);
             sscanf(stg, "%d",&i);
-            machine->WriteMem(machine->ReadRegister(4), 4, i); // get the char
-            delete stg;
+            delete [] stg;
+            // CopyToUser pages in the word, or copies a page on write,
+            // like the store the program would do; WriteMem would not
+            int addr = machine->ReadRegister(4);
+            int word = WordToMachine((unsigned) i);
+            if(!machine->CopyToUser(addr, (char *) &word, sizeof(word)))
+              printf ("SynchGetInt: cannot write to 0x%x\n", addr);
             break;
           }
           case SC_UserThreadCreate:{
@@ -181,6 +193,10 @@ ExceptionHandler (ExceptionType which)
             do_UserThreadExit();
             break;
           }
+          case SC_Fork:{
+            machine->WriteRegister(2, do_Fork());
+            break;
+          }
           case SC_ForkExec:{
             char stg[MAX_STRING_SIZE];
             copyStringFromMachine(4, stg, MAX_STRING_SIZE);
@@ -188,6 +204,39 @@ ExceptionHandler (ExceptionType which)
             do_ForkExec(stg);
             break;
           }
+          case SC_SetPriority:{
+            int priority = machine->ReadRegister(4);
+            if (priority < 0 || priority >= NumPriorities) {
+              machine->WriteRegister(2, -1);
+              break;
+            }
+            machine->WriteRegister(2, currentThread->priority);
+            currentThread->priority = priority;
+            break;
+          }
+          case SC_SetRealTime:{
+            IntStatus oldLevel = interrupt->SetLevel(IntOff);
+            bool ok = scheduler->SetRealTime(currentThread, machine->ReadRegister(4), machine->ReadRegister(5));
+            (void) interrupt->SetLevel(oldLevel);
+            machine->WriteRegister(2, ok ? 0 : -1);
+            break;
+          }
+          case SC_Sleep:{
+            IntStatus oldLevel = interrupt->SetLevel(IntOff);
+            currentThread->SleepFor(machine->ReadRegister(4), NULL);
+            (void) interrupt->SetLevel(oldLevel);
+            break;
+          }
+          case SC_FutexWait:{
+            int result = do_FutexWait(machine->ReadRegister(4), machine->ReadRegister(5));
+            machine->WriteRegister(2, result);
+            break;
+          }
+          case SC_FutexWake:{
+            int result = do_FutexWake(machine->ReadRegister(4), machine->ReadRegister(5));
+            machine->WriteRegister(2, result);
+            break;
+          }
 
           default:{
             printf ("Unexpected user mode exception %d %d\n", which, type);
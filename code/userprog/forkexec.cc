@@ -1,5 +1,6 @@
 #include "forkexec.h"
 #include "addrspace.h"
+#include "profile.h"
 
 
 static void StartForkedProcess(int arg) {
@@ -15,14 +16,16 @@ static void StartForkedProcess(int arg) {
 int do_ForkExec (char *filename)
 {
     OpenFile *executable = fileSystem->Open (filename);
-    AddrSpace *space = new AddrSpace(executable); // création du nouvel espace mémoir du processus que l'on va mettre en place
-
-    Thread* newThread = new Thread("newProcess"); // un processus est juste un thread avec un nouvel espace mémoir
     if (executable == NULL)
     {
         fprintf(stderr, "%s", "Error when opening the file\n");
         return -1;
     }
+    AddrSpace *space = new AddrSpace(executable); // création du nouvel espace mémoir du processus que l'on va mettre en place, qui garde l'exécutable ouvert
+
+    Thread* newThread = new Thread("newProcess"); // un processus est juste un thread avec un nouvel espace mémoir
+    if (machine->profiler != NULL)
+        machine->profiler->LoadSymbols(filename);
 
     //Process
     if(space == NULL)
@@ -37,11 +40,48 @@ int do_ForkExec (char *filename)
     machine->newProcess();
     newThread->Fork(StartForkedProcess,(int)sarg); // on fork le processus père
 
-    delete executable;
-
     return 0;
 }
 
+static void StartForkedChild(int arg) {
+    ForkContainer* farg = (ForkContainer*) arg;
+    currentThread->space = farg->space;
+
+    currentThread->space->RestoreState();
+    for (int i = 0; i < NumTotalRegs; i++)
+        machine->WriteRegister(i, farg->registers[i]); // on repart d'où le père a appelé Fork
+    delete farg;
+    machine->Run();
+}
+
+// Fork: the new process gets a copy-on-write copy of the address space
+// of the calling thread (see Pager::Fork), and goes on from the same
+// point, with Fork returning 0.  The parent gets the number of the
+// child, counting from 1 (there are no process ids).  Fork takes no
+// frame nor swap slot, so it cannot fail; running out of memory when
+// a shared page is copied later is fatal, as for any page fault.
+int do_Fork()
+{
+    static int forkCount = 0;
+    AddrSpace *space = new AddrSpace(currentThread->space, machine->ReadRegister(StackReg));
+    Thread* newThread = new Thread("forkedProcess");
+    ForkContainer* farg = new ForkContainer;
+    newThread->setId(currentThread->getId()); // le même thread, dans le nouvel espace
+
+    farg->space = space;
+    for (int i = 0; i < NumTotalRegs; i++)
+        farg->registers[i] = machine->ReadRegister(i);
+    farg->registers[2] = 0; // Fork returns 0 in the child
+    farg->registers[PrevPCReg] = farg->registers[PCReg]; // as UpdatePC does
+    farg->registers[PCReg] = farg->registers[NextPCReg];
+    farg->registers[NextPCReg] += 4;
+
+    machine->newProcess();
+    newThread->Fork(StartForkedChild,(int)farg);
+
+    return ++forkCount;
+}
+
 void do_Exit()
 {
     machine->deleteProcess(); // -1
@@ -9,7 +9,15 @@ struct SpaceContainer{
 	AddrSpace* space;
 };
 
+// The registers a forked process starts with: those of its parent,
+// at the return from Fork
+struct ForkContainer{
+	AddrSpace* space;
+	int registers[NumTotalRegs];
+};
+
 extern int do_ForkExec (char *filename);
+extern int do_Fork ();
 extern void do_Exit ();
 
 #endif
@@ -7,6 +7,11 @@ static Semaphore* semMemBitMap = new Semaphore("semFrame",1);
 FrameProvider::FrameProvider(int nFrame)
 {
   this->MemBitMap = new BitMap(nFrame);
+  this->users = new int[nFrame];
+  this->zeroed = new bool[nFrame];
+  for(int i = 0; i < nFrame; i++)
+    zeroed[i] = FALSE; // main memory starts out with garbage
+  this->toZero = new Semaphore("toZero", nFrame);
   this->numberOfFrame = MemBitMap->NumClear();
 
   if(this->numberOfFrame != nFrame)
@@ -16,6 +21,9 @@ FrameProvider::FrameProvider(int nFrame)
 FrameProvider::~FrameProvider()
 {
   delete MemBitMap;
+  delete [] users;
+  delete [] zeroed;
+  delete toZero;
 }
 
 int
@@ -24,8 +32,11 @@ FrameProvider::NumAvailFrame()
   return MemBitMap->NumClear();
 }
 
+// The frame is taken from the pool of pre-zeroed frames if "zero", from
+// the others if not, so as to keep the pool for the frames that need it.
+// It is only zeroed here if the pool is empty.
 int
-FrameProvider::GetEmptyFrame()
+FrameProvider::GetEmptyFrame(bool zero)
 {
   semMemBitMap->P();
   if(MemBitMap->NumClear() <= 0){
@@ -34,16 +45,93 @@ FrameProvider::GetEmptyFrame()
     return -1;
   }
 
-  int frame = MemBitMap->Find(); //return -1 if full
+  int frame = -1;
+  for(int i = 0; i < numberOfFrame; i++){
+    if(!MemBitMap->Test(i)){
+      if(frame < 0 || zeroed[i] == zero)
+        frame = i;
+      if(zeroed[i] == zero)
+        break;
+    }
+  }
+  MemBitMap->Mark(frame);
 
-   bzero(&(machine->mainMemory[PageSize * frame]), PageSize);
+   machine->InvalidateCode(frame);
+   if(zero && !zeroed[frame])
+     bzero(&(machine->mainMemory[PageSize * frame]), PageSize);
+  zeroed[frame] = FALSE; // about to be filled
+  users[frame] = 1;
   semMemBitMap->V();
   return frame;
 
 }
 
+// A forked address space maps the frame too, copy-on-write.
+void
+FrameProvider::ShareFrame(int framePosition)
+{
+  semMemBitMap->P();
+  users[framePosition]++;
+  semMemBitMap->V();
+}
+
+// The frame is free once the last page table mapping it lets it go.
 void
 FrameProvider::ReleaseFrame(int framePosition)
 {
-  MemBitMap->Clear(framePosition);
+  semMemBitMap->P();
+  if(--users[framePosition] == 0){
+    machine->InvalidateCode(framePosition);
+    MemBitMap->Clear(framePosition);
+    toZero->V();
+  }
+  semMemBitMap->V();
+}
+
+int
+FrameProvider::FrameUsers(int framePosition)
+{
+  return users[framePosition];
+}
+
+// The zeroing thread fills the pool of pre-zeroed frames, one frame at
+// a time, at the lowest priority: it only gets the CPU when no one else
+// wants it (with "-sched prio"), and otherwise lets the others run
+// between two frames.  It waits on toZero when all the free frames are
+// zeroed, so it does not keep the machine from going idle.
+static void
+ZeroFrames(int arg)
+{
+  FrameProvider *provider = (FrameProvider *) arg;
+
+  for(;;){
+    provider->ZeroFrame();
+    currentThread->Yield();
+  }
+}
+
+void
+FrameProvider::StartZeroing()
+{
+  Thread *zeroer = new Thread("zeroer");
+
+  zeroer->priority = 0;
+  zeroer->Fork(ZeroFrames, (int) this);
+}
+
+// toZero may count frames taken since, not zeroed: then there is
+// nothing to do this time.
+void
+FrameProvider::ZeroFrame()
+{
+  toZero->P();
+  semMemBitMap->P();
+  for(int i = 0; i < numberOfFrame; i++){
+    if(!MemBitMap->Test(i) && !zeroed[i]){
+      bzero(&(machine->mainMemory[PageSize * i]), PageSize);
+      zeroed[i] = TRUE;
+      break;
+    }
+  }
+  semMemBitMap->V();
 }
@@ -5,6 +5,8 @@
 //#include "addrspace.h"
 #include "bitmap.h"
 #include <strings.h>
+
+class Semaphore;
 //#include "filesys.h"
 //#include "synch.h"
 
@@ -15,12 +17,20 @@ class FrameProvider
         FrameProvider(int);
         ~FrameProvider();
 
-        int GetEmptyFrame();
-        void ReleaseFrame(int frame);
+        int GetEmptyFrame(bool zero); // the frame has one user, and
+                // only holds zeroes if "zero"
+        void StartZeroing(); // fork the thread zeroing the free frames
+        void ZeroFrame(); // zero a free frame, waiting for one if needed
+        void ShareFrame(int frame); // one more user (see Pager::Fork)
+        void ReleaseFrame(int frame); // one user less, free at the last
+        int FrameUsers(int frame);
         int NumAvailFrame(void);
 
     private:
         BitMap* MemBitMap;
+        int* users; // number of page tables mapping each frame
+        bool* zeroed; // free frames known to hold only zeroes
+        Semaphore* toZero; // counts the frames freed, not zeroed yet
         int numberOfFrame; // number of free frames in the bitmap
 };
 
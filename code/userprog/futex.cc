@@ -0,0 +1,92 @@
+// futex.cc
+//	Routines to wait on, and wake up, a word of user memory.
+//
+//	Like the routines in synch.cc, these assume a uniprocessor, and
+//	get atomicity by turning off interrupts.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "futex.h"
+#include "system.h"
+
+// The threads waiting on a word, hashed by its virtual address.  A
+// thread remembers the address it waits on in "futexKey", and the
+// address space in "space".
+static IntrusiveList<Thread> futexQueue[FutexBuckets];
+
+//----------------------------------------------------------------------
+// do_FutexWait
+//      Put the current thread to sleep on the user word at "addr",
+//      provided the word still holds "value".  Checking the word and
+//      going to sleep are atomic, so a FutexWake that follows a change
+//      of the word is never missed.
+//
+//      Reading the word may bring its page in, and block; but nothing
+//      blocks between the read and the sleep.
+//
+//      Return 0 once woken up, -1 at once if the word does not hold
+//      "value" or "addr" is not valid.
+//----------------------------------------------------------------------
+
+int
+do_FutexWait (int addr, int value)
+{
+    IntStatus oldLevel = interrupt->SetLevel (IntOff);
+    unsigned int word;
+
+    if ((addr & 0x3) != 0
+	|| !machine->CopyFromUser (addr, (char *) &word, sizeof (word))
+	|| (int) WordToHost (word) != value)
+      {
+	  (void) interrupt->SetLevel (oldLevel);
+	  return -1;
+      }
+    DEBUG ('a', "Thread %s waits on futex 0x%x\n",
+	   currentThread->getName (), addr);
+    currentThread->futexKey = addr;
+    futexQueue[(addr >> 2) & (FutexBuckets - 1)].Append (currentThread);
+    currentThread->Sleep ();
+    (void) interrupt->SetLevel (oldLevel);
+    return 0;
+}
+
+//----------------------------------------------------------------------
+// do_FutexWake
+//      Wake up at most "count" threads waiting on the user word at
+//      "addr", the oldest first.
+//
+//      Return the number of threads woken up, -1 if "addr" is not
+//      aligned or out of the address space.
+//----------------------------------------------------------------------
+
+int
+do_FutexWake (int addr, int count)
+{
+    IntStatus oldLevel = interrupt->SetLevel (IntOff);
+    IntrusiveList<Thread> *queue;
+    Thread *thread, *next;
+    int woken = 0;
+
+    if ((addr & 0x3) != 0
+	|| (unsigned) addr / PageSize >= machine->pageTableSize)
+      {
+	  (void) interrupt->SetLevel (oldLevel);
+	  return -1;
+      }
+    queue = &futexQueue[(addr >> 2) & (FutexBuckets - 1)];
+    for (thread = queue->First (); thread != NULL && woken < count;
+	 thread = next)
+      {
+	  next = thread->listLink.next->item;	// NULL at the end
+	  if (thread->futexKey != addr || thread->space != currentThread->space)
+	      continue;		// another word in the same bucket
+	  queue->Unlink (thread);
+	  scheduler->ReadyToRun (thread);
+	  woken++;
+      }
+    (void) interrupt->SetLevel (oldLevel);
+    return woken;
+}
@@ -0,0 +1,30 @@
+// futex.h
+//	Fast user-level synchronization: the FutexWait and FutexWake
+//	system calls.
+//
+//	A user lock is a word in user memory.  Taking or releasing it
+//	when nobody waits needs no system call: the user program changes
+//	the word with CompareAndSwap (see test/start.S).  Only a thread
+//	that must wait calls FutexWait, and only a thread that releases
+//	a lock others wait for calls FutexWake (see test/ulock.c).
+//
+//	Waiting threads are kept in a hash table of queues, keyed by the
+//	address space and the virtual address of the word.  Not by its
+//	physical address: the page may be evicted and brought back into
+//	another frame while threads wait on it.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include "copyright.h"
+
+#define FutexBuckets	64	// number of wait queues (a power of 2)
+
+extern int do_FutexWait (int addr, int value);
+extern int do_FutexWake (int addr, int count);
+
+#endif // FUTEX_H
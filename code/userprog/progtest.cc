@@ -15,6 +15,7 @@
 #include "synchconsole.h"
 #include "addrspace.h"
 #include "synch.h"
+#include "profile.h"
 
 //----------------------------------------------------------------------
 // StartProcess
@@ -35,8 +36,10 @@ StartProcess (char *filename)
       }
     space = new AddrSpace (executable);
     currentThread->space = space;
+    if (machine->profiler != NULL)
+	machine->profiler->LoadSymbols (filename);
 
-    delete executable;		// close file
+    // the address space closes "executable" when it is done with it
 
     space->InitRegisters ();	// set the initial register values
     space->RestoreState ();	// load page table register
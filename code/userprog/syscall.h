@@ -39,6 +39,19 @@
 #define SC_UserThreadExit 18
 #define SC_UserThreadJoin 19
 #define SC_ForkExec 20
+#define SC_SetPriority 21
+#define SC_FutexWait 22
+#define SC_FutexWake 23
+#define SC_SetRealTime 24
+#define SC_Sleep 25
+
+/* CompareAndSwap (see start.S) is a restartable atomic sequence, at a
+ * fixed place at the start of every program: a thread switched out
+ * after AtomicSeqBegin, and before AtomicSeqEnd, starts it over, so
+ * that nobody can see it half done (see AddrSpace::SaveState).
+ */
+#define AtomicSeqBegin	8
+#define AtomicSeqEnd	28	/* just after the store */
 
 #ifdef IN_USER_MODE
 
@@ -128,10 +141,14 @@ void Close (OpenFileId id);
  * threads to run within a user program.
  */
 
-/* Fork a thread to run a procedure ("func") in the *same* address space
- * as the current thread.
+/* Create a new process, with a copy of the address space of the
+ * current thread, going on from the return of Fork.  Only the calling
+ * thread is copied.  The pages are shared until one of the two
+ * processes writes to them (copy-on-write).  Returns 0 in the new
+ * process, and in the caller a number, counting from 1, identifying
+ * the new process.
  */
-void Fork (void (*func) ());
+int Fork ();
 
 /* Yield the CPU to another runnable thread, whether in this address space
  * or not.
@@ -166,6 +183,42 @@ int UserThreadJoin(int i);
 
 int ForkExec(char *s);
 
+/* Set the static priority of the calling thread, from 0 (lowest) to 7,
+ * as used by "nachos -sched prio".  Returns the previous priority, or
+ * -1 if "priority" is out of range.
+ */
+int SetPriority(int priority);
+
+/* Put the calling thread in the real-time class: from now on, it may
+ * run "budget" ticks every "period" ticks, and each time it wakes up,
+ * it must be done, i.e. block again, within "period" ticks.  Real-time
+ * threads run before all others, earliest deadline first.  A "period"
+ * of 0 puts the thread back in its normal class.  Returns 0, or -1 if
+ * the budget is not between 1 and the period, or if the real-time
+ * threads would need more than the whole machine.
+ */
+int SetRealTime(int period, int budget);
+
+/* Block the calling thread for "ticks" ticks of simulated time, without
+ * using the CPU meanwhile.
+ */
+void Sleep(int ticks);
+
+/* Atomically: if *addr equals "old", set it to "value".  Returns the
+ * former value of *addr.  Needs no system call.
+ */
+int CompareAndSwap(int *addr, int old, int value);
+
+/* Sleep until a FutexWake on "addr", if *addr still equals "value".
+ * Returns 0 once woken up, -1 at once if *addr differs.
+ */
+int FutexWait(int *addr, int value);
+
+/* Wake up at most "count" threads sleeping in FutexWait on "addr".
+ * Returns the number of threads woken up.
+ */
+int FutexWake(int *addr, int count);
+
 #endif // IN_USER_MODE
 
 #endif /* SYSCALL_H */
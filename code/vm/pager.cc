@@ -0,0 +1,456 @@
+// pager.cc
+//	Routines to bring the pages of the address spaces into main
+//	memory on demand, and to take frames back when memory is full.
+//
+//	One lock protects the core map, the page tables, the
+//	copy-on-write flags and the swap space.  It is held during a whole fault, so two threads of an
+//	address space faulting on the same page load it only once.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "pager.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// Pager::Pager
+//      Initialize the core map (all frames free), and create the swap
+//      space.  Must be called after the file system is initialized.
+//
+//      "policy" chooses the pages to evict (see replace.h).
+//----------------------------------------------------------------------
+
+Pager::Pager (ReplacementPolicy policy)
+{
+    for (int i = 0; i < NumPhysPages; i++)
+      {
+	  coreMap[i].space = NULL;
+	  coreMap[i].entry = NULL;
+	  coreMap[i].next = NULL;
+	  textFile[i] = -1;
+      }
+    swap = new SwapSpace ();
+    replacement = NewReplacement (policy, coreMap);
+    lock = new Lock ("pager");
+}
+
+//----------------------------------------------------------------------
+// Pager::~Pager
+//      Remove the swap space.
+//----------------------------------------------------------------------
+
+Pager::~Pager ()
+{
+    delete swap;
+    delete replacement;
+    delete lock;
+}
+
+//----------------------------------------------------------------------
+// Pager::PageFault
+//      Make the page of the current address space holding "virtAddr"
+//      valid, after a PageFaultException.  The faulting instruction
+//      (or Copy routine) then tries again.
+//
+//      Another thread of the address space may have brought the page
+//      in while we waited for the lock: there is nothing left to do.
+//      Another address space running the same program may hold the
+//      page already, if it is a text page: it is mapped from there.
+//      These are minor faults, as is a fault on a page that only holds
+//      zeroes; the others, which must read the page in, are major.
+//
+//      Return FALSE if no frame could be found.
+//----------------------------------------------------------------------
+
+bool
+Pager::PageFault (int virtAddr)
+{
+    AddrSpace *space = currentThread->space;
+    unsigned int vpn = (unsigned) virtAddr / PageSize;
+    TranslationEntry *entry;
+    int frame;
+
+    ASSERT (vpn < space->numPages);
+    lock->Acquire ();
+    entry = &space->pageTable[vpn];
+    if (entry->valid)
+      {
+	  stats->numPageFaults++;
+	  stats->numMinorFaults++;
+	  lock->Release ();
+	  return TRUE;
+      }
+    frame = FindText (space, vpn);
+    if (frame >= 0)
+      {
+	  DEBUG ('v', "Text page %d of %s is in frame %d\n", vpn,
+		 currentThread->getName (), frame);
+	  stats->numPageFaults++;
+	  stats->numMinorFaults++;
+	  AddOwner (frame, space, vpn);
+	  frameprovider->ShareFrame (frame);
+	  entry->physicalPage = frame;
+	  entry->use = FALSE;
+	  entry->dirty = FALSE;
+	  entry->readOnly = TRUE;
+	  entry->valid = TRUE;
+	  lock->Release ();
+	  return TRUE;
+      }
+    frame = GetFrame (space->swapSlot[vpn] < 0);	// zeroed for LoadPage
+    if (frame < 0)
+      {
+	  lock->Release ();
+	  return FALSE;
+      }
+    stats->numPageFaults++;
+    DEBUG ('v', "Page fault on page %d of %s, into frame %d\n", vpn,
+	   currentThread->getName (), frame);
+    if (space->swapSlot[vpn] >= 0)
+      {
+	  swap->Read (space->swapSlot[vpn], frame);
+	  stats->numMajorFaults++;
+      }
+    else if (space->LoadPage (vpn, frame))
+	stats->numMajorFaults++;
+    else
+	stats->numMinorFaults++;
+    coreMap[frame].space = space;
+    coreMap[frame].vpn = vpn;
+    coreMap[frame].entry = entry;
+    coreMap[frame].next = NULL;
+    if (space->IsText (vpn))
+      {
+	  textFile[frame] = space->executableId;
+	  textPage[frame] = vpn;
+      }
+    replacement->Loaded (frame);
+    entry->physicalPage = frame;
+    entry->use = FALSE;
+    entry->dirty = FALSE;
+    entry->readOnly = space->IsText (vpn);
+    entry->valid = TRUE;
+    lock->Release ();
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Pager::CopyOnWrite
+//      Make the page of the current address space holding "virtAddr"
+//      writable, after a ReadOnlyException.  If the page is still
+//      shared with another address space, it gets a frame of its own,
+//      with a copy of the shared one; if it is not any more, it just
+//      stops being read-only.  The faulting instruction then tries
+//      again.
+//
+//      The page may have been evicted while we waited for the lock, or
+//      while we looked for a frame: the instruction then tries again,
+//      and takes a page fault.
+//
+//      Return FALSE if the page is really read-only, or if no frame
+//      could be found.
+//----------------------------------------------------------------------
+
+bool
+Pager::CopyOnWrite (int virtAddr)
+{
+    AddrSpace *space = currentThread->space;
+    unsigned int vpn = (unsigned) virtAddr / PageSize;
+    TranslationEntry *entry;
+    int shared, frame;
+
+    ASSERT (vpn < space->numPages);
+    lock->Acquire ();
+    entry = &space->pageTable[vpn];
+    if (entry->valid && !space->copyOnWrite[vpn])
+      {
+	  lock->Release ();
+	  return FALSE;
+      }
+    if (entry->valid && frameprovider->FrameUsers (entry->physicalPage) > 1)
+      {
+	  frame = GetFrame (FALSE);
+	  if (frame < 0)
+	    {
+		lock->Release ();
+		return FALSE;
+	    }
+	  if (!entry->valid)
+	    {			// evicted by GetFrame
+		frameprovider->ReleaseFrame (frame);
+		lock->Release ();
+		return TRUE;
+	    }
+	  shared = entry->physicalPage;
+	  DEBUG ('v', "Copy on write of page %d of %s, into frame %d\n",
+		 vpn, currentThread->getName (), frame);
+	  bcopy (&machine->mainMemory[shared * PageSize],
+		 &machine->mainMemory[frame * PageSize], PageSize);
+	  RemoveOwner (shared, space, vpn);
+	  frameprovider->ReleaseFrame (shared);
+	  coreMap[frame].space = space;
+	  coreMap[frame].vpn = vpn;
+	  coreMap[frame].entry = entry;
+	  coreMap[frame].next = NULL;
+	  replacement->Loaded (frame);
+	  entry->physicalPage = frame;
+      }
+    if (entry->valid)
+      {
+	  entry->readOnly = FALSE;
+	  space->copyOnWrite[vpn] = FALSE;
+	  machine->FlushTranslationCache ();
+      }
+    lock->Release ();
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Pager::Fork
+//      Give "child", a new address space of the same size as "parent",
+//      the pages of "parent".  The frames and the swap slots are
+//      shared rather than copied; the pages in memory become read-only
+//      in both spaces, until one of them writes (see CopyOnWrite).
+//
+//      The pages out in the swap space need nothing more: a page
+//      brought back in gets a frame of its own in each space.  The
+//      text pages are read-only already, and stay so.
+//----------------------------------------------------------------------
+
+void
+Pager::Fork (AddrSpace * parent, AddrSpace * child)
+{
+    ASSERT (parent->numPages == child->numPages);
+    lock->Acquire ();
+    for (unsigned int vpn = 0; vpn < parent->numPages; vpn++)
+      {
+	  TranslationEntry *from = &parent->pageTable[vpn];
+	  TranslationEntry *to = &child->pageTable[vpn];
+
+	  child->swapSlot[vpn] = parent->swapSlot[vpn];
+	  if (child->swapSlot[vpn] >= 0)
+	      swap->Share (child->swapSlot[vpn]);
+	  if (!from->valid)
+	      continue;
+	  if (!parent->IsText (vpn))
+	    {
+		from->readOnly = TRUE;
+		parent->copyOnWrite[vpn] = TRUE;
+		child->copyOnWrite[vpn] = TRUE;
+	    }
+	  *to = *from;
+	  AddOwner (from->physicalPage, child, vpn);
+	  frameprovider->ShareFrame (from->physicalPage);
+      }
+    machine->FlushTranslationCache ();	// it may hold writable pages
+    lock->Release ();
+}
+
+//----------------------------------------------------------------------
+// Pager::FreeSpace
+//      Give back the frames and the swap slots held by "space", which
+//      is being deleted.  A frame still shared with another address
+//      space stays with it.
+//----------------------------------------------------------------------
+
+void
+Pager::FreeSpace (AddrSpace * space)
+{
+    lock->Acquire ();
+    for (unsigned int vpn = 0; vpn < space->numPages; vpn++)
+      {
+	  TranslationEntry *entry = &space->pageTable[vpn];
+
+	  if (entry->valid)
+	    {
+		int frame = entry->physicalPage;
+
+		RemoveOwner (frame, space, vpn);
+		if (coreMap[frame].space == NULL)
+		    replacement->Freed (frame);
+		frameprovider->ReleaseFrame (frame);
+		entry->valid = FALSE;
+	    }
+	  if (space->swapSlot[vpn] >= 0)
+	    {
+		swap->Free (space->swapSlot[vpn]);
+		space->swapSlot[vpn] = -1;
+	    }
+      }
+    lock->Release ();
+}
+
+//----------------------------------------------------------------------
+// Pager::GetFrame
+//      Return a frame for a page being brought in.  Take a free one if
+//      there is any; otherwise evict the page chosen by the replacement
+//      policy.  If it cannot be evicted (see Evict), the policy keeps
+//      it and is asked again.
+//
+//      "zero" says whether the frame must only hold zeroes: it then
+//      comes from the pool of pre-zeroed frames, if possible (see
+//      FrameProvider::GetEmptyFrame).
+//----------------------------------------------------------------------
+
+int
+Pager::GetFrame (bool zero)
+{
+    for (int tries = 0; tries <= NumPhysPages; tries++)
+      {
+	  int frame;
+
+	  if (frameprovider->NumAvailFrame () > 0)
+	      return frameprovider->GetEmptyFrame (zero);
+	  frame = replacement->Victim ();
+	  if (frame < 0)
+	      return -1;
+	  if (!Evict (frame))
+	      replacement->Loaded (frame);
+      }
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// Pager::Evict
+//      Take "frame" back from the pages it holds, and give it back to
+//      the frame provider.  The page is written to the swap space if
+//      it was modified since it was brought in; a clean page is read
+//      again from where it came from.
+//
+//      A frame shared by forked address spaces is taken back from all
+//      of them at once.  If any of them modified it, it goes to a new
+//      swap slot, which they all share: the old ones may still hold
+//      the page of another space that did not.  A page of a single
+//      space keeps its slot, unless it shares it.
+//
+//      The pages are made invalid before the write, which may block, so
+//      that their owners cannot change them meanwhile.
+//
+//      Return FALSE if the page is dirty and the swap space is full.
+//----------------------------------------------------------------------
+
+bool
+Pager::Evict (int frame)
+{
+    CoreMapEntry *owner;
+    bool dirty = FALSE, first = TRUE;
+    int slot = coreMap[frame].space->swapSlot[coreMap[frame].vpn];
+
+    for (owner = &coreMap[frame]; owner != NULL; owner = owner->next)
+	dirty = dirty || owner->entry->dirty;
+    if (dirty && (coreMap[frame].next != NULL || slot < 0
+		  || swap->Users (slot) > 1))
+      {
+	  slot = swap->Alloc ();
+	  if (slot < 0)
+	      return FALSE;
+      }
+    DEBUG ('v', "Evicting page %d from frame %d%s\n", coreMap[frame].vpn,
+	   frame, dirty ? " (dirty)" : "");
+    for (owner = &coreMap[frame]; owner != NULL; owner = owner->next)
+	owner->entry->valid = FALSE;
+    machine->FlushTranslationCache ();	// it may hold the page
+    stats->numEvictions++;
+    if (dirty)
+      {
+	  swap->Write (slot, frame);
+	  stats->numDirtyWritebacks++;
+      }
+    while (coreMap[frame].space != NULL)
+      {
+	  AddrSpace *space = coreMap[frame].space;
+	  int vpn = coreMap[frame].vpn;
+
+	  if (dirty && space->swapSlot[vpn] != slot)
+	    {
+		if (space->swapSlot[vpn] >= 0)
+		    swap->Free (space->swapSlot[vpn]);
+		if (!first)
+		    swap->Share (slot);
+		space->swapSlot[vpn] = slot;
+		first = FALSE;
+	    }
+	  space->pageTable[vpn].readOnly = FALSE;
+	  space->copyOnWrite[vpn] = FALSE;
+	  RemoveOwner (frame, space, vpn);
+	  frameprovider->ReleaseFrame (frame);
+      }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Pager::AddOwner
+//      Record that page "vpn" of "space" now maps "frame" as well as
+//      its current owners.
+//----------------------------------------------------------------------
+
+void
+Pager::AddOwner (int frame, AddrSpace * space, int vpn)
+{
+    CoreMapEntry *owner = new CoreMapEntry;
+
+    ASSERT (coreMap[frame].space != NULL);
+    owner->space = space;
+    owner->vpn = vpn;
+    owner->entry = &space->pageTable[vpn];
+    owner->next = coreMap[frame].next;
+    coreMap[frame].next = owner;
+}
+
+//----------------------------------------------------------------------
+// Pager::RemoveOwner
+//      Record that page "vpn" of "space" does not map "frame" any more.
+//      When the first owner goes, the next one takes its place in the
+//      core map; when the last one goes, the frame holds nothing, not
+//      even a text page to share.
+//----------------------------------------------------------------------
+
+void
+Pager::RemoveOwner (int frame, AddrSpace * space, int vpn)
+{
+    CoreMapEntry *owner, *prev;
+
+    if (coreMap[frame].space == space && coreMap[frame].vpn == vpn)
+      {
+	  owner = coreMap[frame].next;
+	  if (owner == NULL)
+	    {
+		coreMap[frame].space = NULL;
+		coreMap[frame].entry = NULL;
+		textFile[frame] = -1;
+		return;
+	    }
+	  coreMap[frame] = *owner;
+	  delete owner;
+	  return;
+      }
+    for (prev = &coreMap[frame]; prev->next != NULL; prev = prev->next)
+	if (prev->next->space == space && prev->next->vpn == vpn)
+	  {
+	      owner = prev->next;
+	      prev->next = owner->next;
+	      delete owner;
+	      return;
+	  }
+    ASSERT (FALSE);		// not an owner
+}
+
+//----------------------------------------------------------------------
+// Pager::FindText
+//      Return the frame holding text page "vpn" of the program run by
+//      "space", -1 if no address space brought it in, or if it is not
+//      a text page.
+//----------------------------------------------------------------------
+
+int
+Pager::FindText (AddrSpace * space, int vpn)
+{
+    if (!space->IsText (vpn))
+	return -1;
+    for (int frame = 0; frame < NumPhysPages; frame++)
+	if (textFile[frame] == space->executableId && textPage[frame] == vpn)
+	    return frame;
+    return -1;
+}
@@ -0,0 +1,95 @@
+// pager.h
+//	Data structures for demand paging.
+//
+//	The pages of an address space start out invalid.  The first
+//	access to a page raises a PageFaultException, and the pager
+//	then finds it a frame and fills it: from the swap space if the
+//	page was written out, else from the executable (code and
+//	initialized data) or with zeroes (the rest).
+//
+//	When no frame is free, the pager takes one back from some
+//	address space, writing its page to the swap space first if it
+//	was modified.  The victim is chosen by the replacement policy
+//	(see replace.h).
+//
+//	A forked address space shares the frames of its parent: the
+//	pages of both are made read-only, and the first one to write to
+//	a page gets a copy of it, on the ReadOnlyException.
+//
+//	The text pages (see AddrSpace::IsText) are shared too, between
+//	all the address spaces running the same program: a fault on one
+//	first looks for a frame already holding it.  They are read-only
+//	for good, and are never written out.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PAGER_H
+#define PAGER_H
+
+#include "copyright.h"
+#include "machine.h"
+#include "swap.h"
+#include "replace.h"
+
+class AddrSpace;
+class Lock;
+
+// The following class records which page of which address space
+// each physical frame holds.
+
+class CoreMapEntry
+{
+  public:
+    AddrSpace *space;		// owner of the frame, NULL if the frame
+				// is free or not pageable
+    int vpn;			// virtual page held by the frame
+    TranslationEntry *entry;	// and its page table entry, NULL if
+				// "space" is
+    CoreMapEntry *next;		// the other owners, if the frame is
+				// shared copy-on-write
+};
+
+class Pager
+{
+  public:
+    Pager (ReplacementPolicy policy);	// Create the swap space
+    ~Pager ();			// and remove it
+
+    bool PageFault (int virtAddr);	// Bring in the page of the current
+				// address space holding "virtAddr".
+				// Return FALSE if no frame can be found
+    bool CopyOnWrite (int virtAddr);	// Same, to make that page
+				// writable; FALSE if it is not
+				// copy-on-write or no frame can be found
+    void Fork (AddrSpace *parent, AddrSpace *child);	// Share the
+				// pages of "parent" with "child"
+    void FreeSpace (AddrSpace *space);	// Give back the frames and the
+				// swap slots of "space"
+
+  private:
+    int GetFrame (bool zero);	// Return a free frame, zeroed if
+				// "zero", evicting a page if needed; -1
+				// if none can be evicted
+    bool Evict (int frame);	// Take "frame" back from its owners;
+				// FALSE if it cannot be written out
+    void AddOwner (int frame, AddrSpace *space, int vpn);
+    void RemoveOwner (int frame, AddrSpace *space, int vpn);
+				// "frame" is now mapped, or no longer,
+				// by page "vpn" of "space"
+    int FindText (AddrSpace *space, int vpn);	// Frame holding text
+				// page "vpn" of the program of "space",
+				// -1 if none
+
+    CoreMapEntry coreMap[NumPhysPages];
+    int textFile[NumPhysPages];	// Identity of the program whose text
+    int textPage[NumPhysPages];	// page each frame holds, -1 if it
+				// holds none
+    SwapSpace *swap;
+    Replacement *replacement;	// chooses the pages to evict
+    Lock *lock;			// held during a whole fault: the swap
+				// and file I/O may block
+};
+
+#endif // PAGER_H
@@ -0,0 +1,301 @@
+// replace.cc
+//	Routines implementing the page replacement policies: FIFO,
+//	clock, second chance, WSClock and sampled LRU.
+//
+//	These routines are only called with the pager lock held (see
+//	pager.cc).
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "replace.h"
+#include "pager.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// NewReplacement
+//      Create a replacement policy following "policy", choosing among
+//      the frames described by "map".
+//----------------------------------------------------------------------
+
+Replacement *
+NewReplacement (ReplacementPolicy policy, CoreMapEntry * map)
+{
+    switch (policy)
+      {
+      case ReplaceClock:
+	  return new ClockReplacement (map);
+      case ReplaceSecondChance:
+	  return new SecondChanceReplacement (map);
+      case ReplaceWSClock:
+	  return new WSClockReplacement (map);
+      case ReplaceLru:
+	  return new LruReplacement (map);
+      default:
+	  return new FifoReplacement (map);
+      }
+}
+
+//----------------------------------------------------------------------
+// Replacement::HoldsPage
+//      Return TRUE if "frame" holds a page the pager may evict.
+//----------------------------------------------------------------------
+
+bool
+Replacement::HoldsPage (int frame)
+{
+    return coreMap[frame].entry != NULL;
+}
+
+//----------------------------------------------------------------------
+// Replacement::Used
+//      Return TRUE if the page held by "frame" was used since the last
+//      call, through the page table of any of its owners (a text page,
+//      or a page shared copy-on-write, has several).  The use bits of
+//      all the owners are cleared.
+//----------------------------------------------------------------------
+
+bool
+Replacement::Used (int frame)
+{
+    bool used = FALSE;
+
+    for (CoreMapEntry * owner = &coreMap[frame]; owner != NULL;
+	 owner = owner->next)
+      {
+	  used = used || owner->entry->use;
+	  owner->entry->use = FALSE;
+      }
+    return used;
+}
+
+//----------------------------------------------------------------------
+// Replacement::Dirty
+//      Return TRUE if the page held by "frame" was written through the
+//      page table of any of its owners, and must be written out before
+//      the frame is reused.
+//----------------------------------------------------------------------
+
+bool
+Replacement::Dirty (int frame)
+{
+    for (CoreMapEntry * owner = &coreMap[frame]; owner != NULL;
+	 owner = owner->next)
+	if (owner->entry->dirty)
+	    return TRUE;
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// FifoReplacement
+//      The frames holding a page are queued in the order the pages
+//      were brought in.
+//----------------------------------------------------------------------
+
+FifoReplacement::FifoReplacement (CoreMapEntry * map):Replacement (map)
+{
+    head = count = 0;
+}
+
+void
+FifoReplacement::Loaded (int frame)
+{
+    ASSERT (count < NumPhysPages);
+    queue[(head + count) % NumPhysPages] = frame;
+    count++;
+}
+
+void
+FifoReplacement::Freed (int frame)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+	if (queue[(head + i) % NumPhysPages] == frame)
+	    break;
+    if (i == count)
+	return;			// not queued
+    for (; i < count - 1; i++)
+	queue[(head + i) % NumPhysPages] =
+	    queue[(head + i + 1) % NumPhysPages];
+    count--;
+}
+
+int
+FifoReplacement::Victim ()
+{
+    int frame;
+
+    if (count == 0)
+	return -1;
+    frame = queue[head];
+    head = (head + 1) % NumPhysPages;
+    count--;
+    return frame;
+}
+
+//----------------------------------------------------------------------
+// SecondChanceReplacement::Victim
+//      Take the oldest page, unless its use bit is set: then clear it
+//      and queue the page again.  After a whole round, no use bit is
+//      left set, so the loop ends.
+//----------------------------------------------------------------------
+
+int
+SecondChanceReplacement::Victim ()
+{
+    int rounds = count;
+
+    for (int i = 0; i < rounds; i++)
+      {
+	  int frame = FifoReplacement::Victim ();
+
+	  if (!Used (frame))
+	      return frame;
+	  Loaded (frame);
+      }
+    return FifoReplacement::Victim ();
+}
+
+//----------------------------------------------------------------------
+// ClockReplacement::Victim
+//      Move the hand round the frames, clearing the use bits, up to the
+//      first page found unused.  Two rounds are enough: the first one
+//      clears every use bit.
+//----------------------------------------------------------------------
+
+ClockReplacement::ClockReplacement (CoreMapEntry * map):Replacement (map)
+{
+    hand = 0;
+}
+
+int
+ClockReplacement::Victim ()
+{
+    for (int i = 0; i < 2 * NumPhysPages; i++)
+      {
+	  int frame = hand;
+
+	  hand = (hand + 1) % NumPhysPages;
+	  if (!HoldsPage (frame))
+	      continue;
+	  if (!Used (frame))
+	      return frame;
+      }
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// WSClockReplacement::Victim
+//      Move the hand round the frames.  A page used since the hand last
+//      passed is stamped with the current time, and stays.  The first
+//      clean page out of the working set goes.
+//
+//      If there is none, the dirty page, or the page of the working
+//      set, unused for the longest time goes.  (A real WSClock would
+//      start writing out the old dirty pages and go on; our writes are
+//      synchronous, so this would gain nothing.)
+//----------------------------------------------------------------------
+
+WSClockReplacement::WSClockReplacement (CoreMapEntry * map):ClockReplacement
+    (map)
+{
+    for (int i = 0; i < NumPhysPages; i++)
+	lastUse[i] = 0;
+}
+
+void
+WSClockReplacement::Loaded (int frame)
+{
+    lastUse[frame] = stats->totalTicks;
+}
+
+int
+WSClockReplacement::Victim ()
+{
+    long long now = stats->totalTicks;
+    int oldest = -1;
+
+    for (int i = 0; i < 2 * NumPhysPages; i++)
+      {
+	  int frame = hand;
+
+	  hand = (hand + 1) % NumPhysPages;
+	  if (!HoldsPage (frame))
+	      continue;
+	  if (Used (frame))
+	    {
+		lastUse[frame] = now;
+		continue;
+	    }
+	  if (!Dirty (frame) && now - lastUse[frame] > WSClockWindow)
+	      return frame;
+	  if (oldest < 0 || lastUse[frame] < lastUse[oldest])
+	      oldest = frame;
+      }
+    if (oldest >= 0)
+	hand = (oldest + 1) % NumPhysPages;
+    return oldest;
+}
+
+//----------------------------------------------------------------------
+// LruReplacement
+//      The frames holding a page are kept in an array, so that they can
+//      be drawn at random.
+//----------------------------------------------------------------------
+
+LruReplacement::LruReplacement (CoreMapEntry * map):Replacement (map)
+{
+    count = 0;
+}
+
+void
+LruReplacement::Loaded (int frame)
+{
+    age[frame] = 0;
+    position[frame] = count;
+    frames[count++] = frame;
+}
+
+void
+LruReplacement::Freed (int frame)
+{
+    Remove (frame);
+}
+
+void
+LruReplacement::Remove (int frame)
+{
+    int last = frames[--count];
+
+    frames[position[frame]] = last;
+    position[last] = position[frame];
+}
+
+//----------------------------------------------------------------------
+// LruReplacement::Victim
+//      Age every page, then take the oldest of LruSamples pages drawn
+//      at random (a page may be drawn twice).
+//----------------------------------------------------------------------
+
+int
+LruReplacement::Victim ()
+{
+    int victim = -1;
+
+    if (count == 0)
+	return -1;
+    for (int i = 0; i < count; i++)
+	age[frames[i]] = (age[frames[i]] >> 1) | (Used (frames[i]) ? 0x80 : 0);
+    for (int i = 0; i < LruSamples; i++)
+      {
+	  int frame = frames[Random () % count];
+
+	  if (victim < 0 || age[frame] < age[victim])
+	      victim = frame;
+      }
+    Remove (victim);
+    return victim;
+}
@@ -0,0 +1,167 @@
+// replace.h
+//	Page replacement policies: which page the pager evicts when no
+//	frame is free.  Five policies are provided ("nachos -replace
+//	<policy>"):
+//
+//	fifo -- the page brought in first goes first, used or not.
+//
+//	clock -- a hand goes round the frames.  A page whose use bit is
+//		set has its bit cleared, and is passed over; the first
+//		page found unused goes.
+//
+//	second -- second chance: the pages are kept in the order they
+//		were brought in.  The oldest page goes, unless it was
+//		used since it got to the front: it then goes back to
+//		the end of the queue, with its use bit cleared.
+//
+//	wsclock -- clock over the working set.  A page used recently
+//		(less than WSClockWindow ticks ago) is part of the
+//		working set of its program, and stays.  The hand looks
+//		for an old clean page, which can go without being
+//		written out; failing that, the oldest unused page goes.
+//
+//	lru -- sampled least recently used.  On each eviction, every
+//		page ages: its use bit is shifted into an 8-bit age,
+//		then cleared.  Among LruSamples pages drawn at random,
+//		the one least recently used goes.
+//
+//	The policies only look at the use and dirty bits that the
+//	hardware sets in the page tables (see Machine::Translate): they
+//	are told nothing of the accesses themselves.  A frame shared by
+//	several address spaces is used (or dirty) if any of its owners
+//	used (or wrote) it.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef REPLACE_H
+#define REPLACE_H
+
+#include "copyright.h"
+#include "machine.h"
+
+class CoreMapEntry;
+
+// Replacement policies, as selected by "-replace"
+enum ReplacementPolicy { ReplaceFifo, ReplaceClock, ReplaceSecondChance,
+    ReplaceWSClock, ReplaceLru
+};
+
+#define WSClockWindow	20000	// ticks a page stays in the working set
+				// after its last use
+#define LruSamples	8	// pages compared for each eviction
+
+// The following class defines the interface of a replacement policy.
+// The pager calls Loaded when a frame gets a page, Freed when a frame
+// is given back, and Victim when it needs a frame.  A frame returned
+// by Victim is out of the policy; if the pager cannot evict its page
+// after all, it calls Loaded again.
+
+class Replacement
+{
+  public:
+    Replacement (CoreMapEntry * map)
+    {
+	coreMap = map;
+    }
+    virtual ~Replacement () {}
+
+    virtual void Loaded (int frame) {}	// "frame" now holds a page
+    virtual void Freed (int frame) {}	// "frame" was given back
+    virtual int Victim () = 0;	// Return the frame to take back,
+    // -1 if no frame holds a page
+
+  protected:
+    CoreMapEntry *coreMap;	// what each frame holds, indexed by
+    // frame (see pager.h)
+
+    bool HoldsPage (int frame);	// Does "frame" hold a page?
+    bool Used (int frame);	// Return whether an owner of "frame"
+    // used it, and clear the use bits of all its owners
+    bool Dirty (int frame);	// Did an owner of "frame" write it?
+};
+
+extern Replacement *NewReplacement (ReplacementPolicy policy,
+				    CoreMapEntry * map);
+				// Create a policy choosing among the
+				// frames of "map"
+
+// First in, first out.
+
+class FifoReplacement:public Replacement
+{
+  public:
+    FifoReplacement (CoreMapEntry * map);
+
+    void Loaded (int frame);
+    void Freed (int frame);
+    int Victim ();
+
+  protected:
+    int queue[NumPhysPages];	// frames, oldest page first, in a
+    int head, count;		// circular buffer
+};
+
+// Second chance: FIFO, skipping the pages used lately.
+
+class SecondChanceReplacement:public FifoReplacement
+{
+  public:
+    SecondChanceReplacement (CoreMapEntry * map):FifoReplacement (map)
+    {
+    }
+
+    int Victim ();
+};
+
+// Clock.
+
+class ClockReplacement:public Replacement
+{
+  public:
+    ClockReplacement (CoreMapEntry * map);
+
+    int Victim ();
+
+  protected:
+    int hand;			// next frame to consider
+};
+
+// WSClock.
+
+class WSClockReplacement:public ClockReplacement
+{
+  public:
+    WSClockReplacement (CoreMapEntry * map);
+
+    void Loaded (int frame);
+    int Victim ();
+
+  private:
+    long long lastUse[NumPhysPages];	// time each page was last seen
+    // used
+};
+
+// Sampled LRU.
+
+class LruReplacement:public Replacement
+{
+  public:
+    LruReplacement (CoreMapEntry * map);
+
+    void Loaded (int frame);
+    void Freed (int frame);
+    int Victim ();
+
+  private:
+    unsigned char age[NumPhysPages];	// use bits of the last 8
+    // evictions, the latest in the high bit
+    int frames[NumPhysPages];	// the frames holding a page, in any
+    int position[NumPhysPages];	// order, and where each one is in
+    int count;			// "frames"
+
+    void Remove (int frame);	// take "frame" out of "frames"
+};
+
+#endif // REPLACE_H
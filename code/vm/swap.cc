@@ -0,0 +1,121 @@
+// swap.cc
+//	Routines to manage the swap space: a file holding the pages
+//	evicted from main memory, one per page-sized slot.
+//
+//	The slots are only touched with the pager lock held (see
+//	pager.cc), so no synchronization is done here.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "swap.h"
+#include "system.h"
+
+static char swapFileName[] = SwapFileName;
+
+//----------------------------------------------------------------------
+// SwapSpace::SwapSpace
+//      Create the swap file, or reuse the one left by a previous run.
+//      If there is no room for it, no page can be written out: only
+//      the clean pages are then evicted.
+//----------------------------------------------------------------------
+
+SwapSpace::SwapSpace ()
+{
+    int numSlots = NumSwapPages;
+
+    (void) fileSystem->Create (swapFileName, NumSwapPages * PageSize);
+    file = fileSystem->Open (swapFileName);
+    slots = new BitMap (NumSwapPages);
+    if (file == NULL)
+	numSlots = 0;
+#ifdef FILESYS
+    else if (file->Length () < NumSwapPages * PageSize)
+	numSlots = file->Length () / PageSize;
+#endif
+    if (numSlots == 0)
+	printf ("Warning: no swap space, dirty pages stay in memory\n");
+    for (int i = numSlots; i < NumSwapPages; i++)
+	slots->Mark (i);
+    DEBUG ('v', "Swap space of %d pages\n", numSlots);
+}
+
+//----------------------------------------------------------------------
+// SwapSpace::~SwapSpace
+//      Close the swap file and remove it.
+//----------------------------------------------------------------------
+
+SwapSpace::~SwapSpace ()
+{
+    if (file != NULL)
+      {
+	  delete file;
+	  fileSystem->Remove (swapFileName);
+      }
+    delete slots;
+}
+
+//----------------------------------------------------------------------
+// SwapSpace::Alloc
+//      Return a free slot, or -1 if the swap space is full.
+//----------------------------------------------------------------------
+
+int
+SwapSpace::Alloc ()
+{
+    int slot = slots->Find ();
+
+    if (slot >= 0)
+	users[slot] = 1;
+    return slot;
+}
+
+//----------------------------------------------------------------------
+// SwapSpace::Share
+//      One more page, in a forked address space, uses "slot".
+//----------------------------------------------------------------------
+
+void
+SwapSpace::Share (int slot)
+{
+    users[slot]++;
+}
+
+//----------------------------------------------------------------------
+// SwapSpace::Free
+//      A page no longer needs "slot".  The slot is free once no page
+//      needs it.
+//----------------------------------------------------------------------
+
+void
+SwapSpace::Free (int slot)
+{
+    if (--users[slot] == 0)
+	slots->Clear (slot);
+}
+
+//----------------------------------------------------------------------
+// SwapSpace::Write
+// SwapSpace::Read
+//      Copy the contents of physical "frame" into "slot" of the swap
+//      file, or the reverse.  The caller is in charge of dropping the
+//      decoded copy of a frame read into (see Machine::InvalidateCode).
+//----------------------------------------------------------------------
+
+void
+SwapSpace::Write (int slot, int frame)
+{
+    DEBUG ('v', "Writing frame %d to swap slot %d\n", frame, slot);
+    file->WriteAt (&machine->mainMemory[frame * PageSize], PageSize,
+		   slot * PageSize);
+}
+
+void
+SwapSpace::Read (int slot, int frame)
+{
+    DEBUG ('v', "Reading swap slot %d into frame %d\n", slot, frame);
+    file->ReadAt (&machine->mainMemory[frame * PageSize], PageSize,
+		  slot * PageSize);
+}
@@ -0,0 +1,57 @@
+// swap.h
+//	Data structures to keep the pages evicted from main memory.
+//
+//	The swap space is a file of the Nachos file system, cut into
+//	page-sized slots.  A page written out keeps its slot until its
+//	address space is deleted, so that a page evicted again without
+//	having been modified needs no write.  A slot is shared by the
+//	address spaces forked from one another, until they modify the
+//	page.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SWAP_H
+#define SWAP_H
+
+#include "copyright.h"
+#include "bitmap.h"
+#include "filesys.h"
+#include "machine.h"
+
+#define SwapFileName	"SWAP"
+
+#ifdef FILESYS
+#include "filehdr.h"
+#define NumSwapPages	((int) (MaxFileSize / PageSize))	// a Nachos file
+							// cannot grow more
+#else
+#define NumSwapPages	(4 * NumPhysPages)
+#endif
+
+class SwapSpace
+{
+  public:
+    SwapSpace ();		// Create the swap file
+    ~SwapSpace ();		// Close and remove it
+
+    int Alloc ();		// Return a free slot, -1 if none
+    void Share (int slot);	// One more page uses "slot"
+    void Free (int slot);	// One less; free at the last
+    int Users (int slot)	// Pages using "slot"
+    {
+	return users[slot];
+    }
+
+    void Write (int slot, int frame);	// Copy physical "frame" out to
+    void Read (int slot, int frame);	// "slot", or back from it
+
+  private:
+    OpenFile *file;		// the swap file, NULL if it could not
+				// be created
+    BitMap *slots;		// which slots hold a page
+    int users[NumSwapPages];	// and for how many pages
+};
+
+#endif // SWAP_H